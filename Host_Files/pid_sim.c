@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// pid_sim.c : host simulation of the wheel speed controllers
+// =========
+//
+// Description
+//      Runs the controller in User_Files/speed_control.c against a first
+//      order model of each motor, with the encoders sampled once per RTI
+//      tick and the speed estimated from edge times as in wheel_speed.c.
+//      The right motor is made weaker than the left so the effect of the
+//      cross coupling term on heading can be seen.
+//
+//      With a ramp time given the target rises linearly from 0, as it
+//      does under the trapezoidal profile in motion.c. The count
+//      difference is taken from the start of the run throughout, as the
+//      target ratio does not change (see set_wheel_targets).
+//
+//      Output is one line per controller update :
+//          time(mS), target, left speed, right speed, left PWM, right PWM,
+//          count difference (left - right)
+//
+// Build (from this directory)
+//      gcc -DHOST_SIM -I../Project_Headers -o pid_sim pid_sim.c ../User_Files/speed_control.c
+//
+//      Gains can be overridden for tuning, e.g. -DPID_KP=40 -DPID_KI=4
+//
+// Usage
+//      pid_sim [target mm/S] [run time mS] [ramp time mS]
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "speed_control.h"
+
+#define     TICK_MS             8
+#define     MM_PER_EDGE         6.536       // 1000 / WHEEL_CONSTANT
+#define     SPEED_K             816         // WHEEL_SPEED_K
+#define     EDGE_HISTORY        8
+#define     SPEED_WINDOW        32
+#define     STOP_TICKS          64
+#define     PID_CROSS_LIMIT_SIM PID_CROSS_LIMIT
+
+//
+// first order motor : tau.dv/dt = gain.(pwm - deadband) - v
+//
+typedef struct {
+    double    gain;             // mm/S per % above deadband
+    double    deadband;         // %
+    double    tau;              // S
+    double    speed;            // mm/S
+    double    distance;         // mm
+    long      edges;
+    //
+    // estimator (as wheel_speed.c)
+    //
+    unsigned  edge_time[EDGE_HISTORY];
+    int       edge_index, nos_edges;
+    unsigned  estimate;
+} motor_model_t;
+
+static void motor_run(motor_model_t *m, int pwm, double dt) {
+
+double   drive;
+
+    drive = m->gain * (pwm - m->deadband);
+    if (drive < 0) {
+        drive = 0;
+    }
+    m->speed += (drive - m->speed) * dt / m->tau;
+    m->distance += m->speed * dt;
+}
+
+static void estimate(motor_model_t *m, unsigned now) {
+
+long      edges;
+unsigned  newest, oldest, since, limit;
+int       periods;
+
+    edges = (long)(m->distance / MM_PER_EDGE);
+    if (edges != m->edges) {
+        m->edges = edges;
+        m->edge_time[m->edge_index] = now;
+        m->edge_index = (m->edge_index + 1) & (EDGE_HISTORY - 1);
+        if (m->nos_edges < EDGE_HISTORY) {
+            m->nos_edges++;
+        }
+    }
+    if (m->nos_edges == 0) {
+        return;
+    }
+    newest = m->edge_time[(m->edge_index - 1) & (EDGE_HISTORY - 1)];
+    since = now - newest;
+    if (since > STOP_TICKS) {
+        m->nos_edges = 0;
+        m->estimate = 0;
+        return;
+    }
+    if (m->nos_edges == 1) {
+        return;
+    }
+    periods = m->nos_edges - 1;
+    for (;;) {
+        oldest = m->edge_time[(m->edge_index - 1 - periods) & (EDGE_HISTORY - 1)];
+        if ((periods == 1) || ((newest - oldest) <= SPEED_WINDOW)) {
+            break;
+        }
+        periods--;
+    }
+    m->estimate = (periods * SPEED_K) / (newest - oldest);
+    if (since != 0) {
+        limit = SPEED_K / since;
+        if (limit < m->estimate) {
+            m->estimate = limit;
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+
+motor_model_t  left  = { .gain = 6.0, .deadband = 15.0, .tau = 0.15, .speed = 0.0 };
+motor_model_t  right = { .gain = 5.4, .deadband = 18.0, .tau = 0.15, .speed = 0.0 };
+wheel_pid_t    left_pid, right_pid;
+unsigned       tick, ticks, target, setpoint, ramp;
+int            left_pwm, right_pwm, cross, ms;
+int16_t        left_error, right_error;
+
+    target = (argc > 1) ? atoi(argv[1]) : 250;
+    ticks = ((argc > 2) ? atoi(argv[2]) : 3000) / TICK_MS;
+    ramp = ((argc > 3) ? atoi(argv[3]) : 0) / TICK_MS;
+    wheel_pid_reset(&left_pid);
+    wheel_pid_reset(&right_pid);
+    left_pwm = 0;
+    right_pwm = 0;
+    printf("time, target, left, right, left_pwm, right_pwm, difference\n");
+    for (tick = 1 ; tick <= ticks ; tick++) {
+        for (ms = 0 ; ms < TICK_MS ; ms++) {
+            motor_run(&left, left_pwm, 0.001);
+            motor_run(&right, right_pwm, 0.001);
+        }
+        estimate(&left, tick);
+        estimate(&right, tick);
+        if ((tick % PID_PERIOD) != 0) {
+            continue;
+        }
+        setpoint = target;
+        if (tick < ramp) {
+            setpoint = (target * tick) / ramp;
+        }
+        left_error = (int16_t)(setpoint - left.estimate);
+        right_error = (int16_t)(setpoint - right.estimate);
+        cross = (int)(left.edges - right.edges);
+        if (cross > PID_CROSS_LIMIT_SIM) {
+            cross = PID_CROSS_LIMIT_SIM;
+        } else if (cross < -PID_CROSS_LIMIT_SIM) {
+            cross = -PID_CROSS_LIMIT_SIM;
+        }
+        left_error -= PID_KC * cross;
+        right_error += PID_KC * cross;
+        left_pwm = wheel_pid_step(&left_pid, setpoint, left_error);
+        right_pwm = wheel_pid_step(&right_pid, setpoint, right_error);
+        printf("%u, %u, %.0f, %.0f, %d, %d, %ld\n", tick * TICK_MS, setpoint,
+                    left.speed, right.speed, left_pwm, right_pwm, left.edges - right.edges);
+    }
+    return 0;
+}
@@ -0,0 +1,166 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// telemetry_decode.c : convert robot telemetry frames to CSV
+// ==================
+//
+// Description
+//      Reads the raw serial stream from the robot (User_Files/telemetry.c),
+//      splits it at 0x00 delimiters, COBS decodes each frame and checks
+//      its length and CRC-16. Good snapshots are written as CSV lines :
+//
+//          seq, time(mS), adc0 ... adc13, left count, right count,
+//          left speed, right speed, left state, right state,
+//          left PWM, right PWM, switches
+//
+//      time is tick_count_16 x 8mS. Bad frames (including any text sent
+//      by the robot while telemetry runs) are counted and reported on
+//      stderr, as are gaps in the sequence numbers.
+//
+// Build (from this directory)
+//      gcc -DHOST_SIM -I../Project_Headers -o telemetry_decode telemetry_decode.c
+//
+//      The frame layout is taken from Project_Headers/telemetry.h.
+//
+// Usage
+//      telemetry_decode [capture file] > run.csv
+//
+//      With no file the stream is read from stdin, e.g. from a serial port
+//      set to 57600 baud raw mode :
+//          stty -F /dev/ttyUSB0 57600 raw && telemetry_decode < /dev/ttyUSB0
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include "telemetry.h"
+
+#define     MAX_FRAME               256
+#define     TICK_MS                 8
+
+static uint16_t crc16(const uint8_t *data, int length) {
+
+uint16_t   crc = 0xFFFF;
+int        bit;
+
+    while (length-- > 0) {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (bit = 0 ; bit < 8 ; bit++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+//
+// returns decoded length or -1 if the frame is malformed
+//
+static int cobs_decode(const uint8_t *in, int length, uint8_t *out) {
+
+int   in_index, out_index, code, i;
+
+    in_index = 0;
+    out_index = 0;
+    while (in_index < length) {
+        code = in[in_index++];
+        if (code == 0) {
+            return -1;
+        }
+        for (i = 1 ; i < code ; i++) {
+            if (in_index >= length) {
+                return -1;
+            }
+            out[out_index++] = in[in_index++];
+        }
+        if ((code < 0xFF) && (in_index < length)) {
+            out[out_index++] = 0;
+        }
+    }
+    return out_index;
+}
+
+static uint16_t get_16(const uint8_t *buffer) {
+
+    return (uint16_t)(buffer[0] | (buffer[1] << 8));
+}
+
+static void print_header(void) {
+
+int   i;
+
+    printf("seq,time_ms");
+    for (i = 0 ; i < NOS_ADC_CHANNELS ; i++) {
+        printf(",adc%d", i);
+    }
+    printf(",left_count,right_count,left_speed,right_speed,"
+           "left_state,right_state,left_pwm,right_pwm,switches\n");
+}
+
+static void print_snapshot(const uint8_t *raw) {
+
+int   i;
+
+    printf("%u,%lu", raw[TELEMETRY_SEQUENCE], (unsigned long)get_16(&raw[TELEMETRY_TICKS]) * TICK_MS);
+    for (i = 0 ; i < NOS_ADC_CHANNELS ; i++) {
+        printf(",%u", raw[TELEMETRY_ADC + i]);
+    }
+    printf(",%u,%u,%u,%u,%u,%u,%u,%u,0x%02X\n",
+           get_16(&raw[TELEMETRY_LEFT_COUNT]), get_16(&raw[TELEMETRY_RIGHT_COUNT]),
+           get_16(&raw[TELEMETRY_LEFT_SPEED]), get_16(&raw[TELEMETRY_RIGHT_SPEED]),
+           raw[TELEMETRY_MOTOR_STATES] & 0x03, (raw[TELEMETRY_MOTOR_STATES] >> 2) & 0x03,
+           raw[TELEMETRY_LEFT_PWM], raw[TELEMETRY_RIGHT_PWM], raw[TELEMETRY_SWITCHES]);
+}
+
+int main(int argc, char *argv[]) {
+
+FILE      *in;
+uint8_t   frame[MAX_FRAME], raw[MAX_FRAME];
+int       ch, length, raw_length, expected, first;
+long      good, bad, missed;
+
+    in = stdin;
+    if (argc > 1) {
+        in = fopen(argv[1], "rb");
+        if (in == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+    print_header();
+    length = 0;
+    good = bad = missed = 0;
+    expected = 0;
+    first = 1;
+    while ((ch = fgetc(in)) != EOF) {
+        if (ch != 0) {
+            if (length < MAX_FRAME) {
+                frame[length] = (uint8_t)ch;
+            }
+            length++;
+            continue;
+        }
+        if (length == 0) {
+            continue;                               // delimiter pair
+        }
+        raw_length = (length <= MAX_FRAME) ? cobs_decode(frame, length, raw) : -1;
+        length = 0;
+        if ((raw_length != TELEMETRY_RAW_SIZE) || (raw[TELEMETRY_TYPE] != TELEMETRY_SNAPSHOT) ||
+            (crc16(raw, TELEMETRY_PAYLOAD_SIZE) != get_16(&raw[TELEMETRY_PAYLOAD_SIZE]))) {
+            bad++;
+            continue;
+        }
+        if (!first && (raw[TELEMETRY_SEQUENCE] != expected)) {
+            missed += (uint8_t)(raw[TELEMETRY_SEQUENCE] - expected);
+        }
+        first = 0;
+        expected = (uint8_t)(raw[TELEMETRY_SEQUENCE] + 1);
+        good++;
+        print_snapshot(raw);
+        fflush(stdout);
+    }
+    fprintf(stderr, "%ld frames, %ld bad, %ld missed\n", good, bad, missed);
+    return 0;
+}
@@ -1,7 +1,42 @@
 #ifndef __adc_H
 #define __adc_H
-  
+
+#define     NOS_ADC_CHANNELS    DUMMY_LAST_SENSOR
+#define     ADC_SCAN_IDLE       0xFF
+
+#if ADC_10BIT
+#define     ADC_8BIT_SHIFT      2
+#else
+#define     ADC_8BIT_SHIFT      0
+#endif
+
+typedef enum {ADC_FILTER_NONE, ADC_FILTER_EMA, ADC_FILTER_MEDIAN} adc_filter_t;
+
+#define     ADC_CHANNEL_BIT(chan)   ((uint16_t)1 << (chan))
+#define     FRONT_SENSORS           (ADC_CHANNEL_BIT(FRONT_SENSOR_L) | ADC_CHANNEL_BIT(FRONT_SENSOR_C) | ADC_CHANNEL_BIT(FRONT_SENSOR_R))
+
+typedef struct {
+    uint16_t  events;           // ADC_CHANNEL_BIT() of channels that bumped
+    uint8_t   channel;          // first channel to bump
+    uint16_t  time;             // tick_count_16 at first bump
+} bump_watch_t;
+
+extern  bump_watch_t    bump_watch;
+
+extern  uint16_t  adc_value[2][NOS_ADC_CHANNELS];
+extern  uint8_t   adc_sample[2][NOS_ADC_CHANNELS];
+extern  uint8_t   adc_sequence[NOS_ADC_CHANNELS];
+extern  uint8_t   adc_read_bank;
+
 uint8_t get_adc(a2d_channels_t chan);
-uint8_t interrupt_get_adc(a2d_channels_t chan);
+uint16_t get_adc_full(a2d_channels_t chan);
+uint8_t get_adc_fresh(a2d_channels_t chan);
+void init_adc_scan(void);
+void adc_start_scan(void);
+void adc_isr(void);
+void bump_watch_start(uint16_t channels, uint8_t threshold);
+void bump_watch_stop(void);
+uint16_t bump_watch_events(void);
+void bump_watch_clear(void);
 
-#endif /* __adc_H */
\ No newline at end of file
+#endif /* __adc_H */
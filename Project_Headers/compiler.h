@@ -0,0 +1,12 @@
+//----------------------------------------------------------------------------
+// compiler.h
+// ==========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __compiler_H
+#define __compiler_H
+
+uint16_t compile_basic(const char *program);
+
+#endif /* __compiler_H */
@@ -0,0 +1,14 @@
+//----------------------------------------------------------------------------
+// crc.h
+// =====
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __crc_H
+#define __crc_H
+
+#define     CRC16_INIT      0xFFFF          // CRC-16/CCITT-FALSE start value
+
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, uint16_t length);
+
+#endif /* __crc_H */
@@ -13,6 +13,8 @@ uint8_t run_distance_mode_1(void);
 uint8_t run_distance_mode_2(void);
 uint8_t move_distance(uint16_t encoder_counts, motor_t unit, int8_t l_speed, int8_t r_speed);
 void calibrate(void);
+uint8_t load_wheel_thresholds(void);
+uint8_t save_wheel_thresholds(uint8_t left_threshold, uint8_t right_threshold);
 
 
 #endif /* __distance_H */
@@ -13,7 +13,21 @@
 #ifndef __flashio_H
 #define __flashio_H 
 
+//
+// Error codes returned by flash routines. The FSTAT error bits are returned
+// as is, software detected errors use the unused low bits.
+//
+#define     FLASH_OK                0x00
+#define     FLASH_ERR_VERIFY        0x01      // read back did not match source
+#define     FLASH_ERR_RANGE         0x02      // block wraps around end of memory
+#define     FLASH_ERR_ACCESS        0x10      // FSTAT_FACCERR
+#define     FLASH_ERR_PROTECT       0x20      // FSTAT_FPVIOL
+
+extern  uint16_t    flash_error_address;
+extern  uint8_t     flash_wraps;
+
 uint8_t FlashErasePage(uint16_t page);
 uint8_t FlashProgramByte(uint16_t address, uint8_t data);
+uint8_t FlashProgramBlock(uint16_t address, uint8_t *src, uint16_t length);
 
 #endif /* __flashio_H */
\ No newline at end of file
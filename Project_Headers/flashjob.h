@@ -0,0 +1,42 @@
+//----------------------------------------------------------------------------
+// flashjob.h
+// ==========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __flashjob_H
+#define __flashjob_H
+
+#define     FLASH_JOB_QUEUE_SIZE    4       // must be a power of 2
+#define     FLASH_JOB_SLICE         16      // bytes programmed per tick
+//
+// TPM1 wraps (motor PWM periods) in one RTI tick
+//
+#define     FLASH_JOB_TICK_WRAPS    ((uint8_t)(((BUSCLK / TICKS_IN_ONE_SECOND) + ((PWM_COUNT + 1) / 2)) / (PWM_COUNT + 1)))
+//
+// Error code, in addition to the FLASH_ERR_xxx codes
+//
+#define     FLASH_ERR_BUSY          0x40    // robot not stopped
+
+typedef enum {FLASH_JOB_ERASE, FLASH_JOB_WRITE} flash_job_type_t;
+
+typedef void (*flash_job_callback_t)(uint8_t status);
+
+typedef struct {
+    flash_job_type_t      type;
+    uint16_t              address;
+    uint8_t               *src;             // RAM, must stay valid until done
+    uint16_t              length;
+    flash_job_callback_t  callback;         // NULL if not required
+} flash_job_t;
+
+extern  uint16_t    flash_job_ticks_recovered;
+
+uint8_t flash_job_submit(flash_job_type_t type, uint16_t address, uint8_t *src, uint16_t length, flash_job_callback_t callback);
+uint8_t flash_job_pending(void);
+void flash_job_poll(void);
+uint8_t flash_job_wait(void);
+uint8_t flash_erase(uint16_t page);
+uint8_t flash_write(uint16_t address, uint8_t *src, uint16_t length);
+
+#endif /* __flashjob_H */
@@ -0,0 +1,27 @@
+//----------------------------------------------------------------------------
+// format.h
+// ========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __format_H
+#define __format_H
+
+#define     FORMAT_BUFFER_SIZE      12      // "-2147483648" + NUL
+
+char *fmt_str(char *buffer, const char *string);
+char *fmt_u8(char *buffer, uint8_t value);
+char *fmt_u16(char *buffer, uint16_t value);
+char *fmt_s16(char *buffer, int16_t value);
+char *fmt_u32(char *buffer, uint32_t value);
+char *fmt_s32(char *buffer, int32_t value);
+char *fmt_hex8(char *buffer, uint8_t value);
+char *fmt_hex16(char *buffer, uint16_t value);
+char *fmt_fixed(char *buffer, int16_t value, uint8_t places);
+
+void send_u16(uint16_t value);
+void send_s16(int16_t value);
+void send_u32(uint32_t value);
+void send_fixed(int16_t value, uint8_t places);
+
+#endif /* __format_H */
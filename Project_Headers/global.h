@@ -6,7 +6,6 @@
 //
 // set of system and application header files
 //
-#include <stdio.h>
 #include <setjmp.h> 
 
 #include <string.h>
@@ -45,18 +44,32 @@
 #include "tokenizer.h"
 #include "ubasic.h"
 #include "scripts.h"
+#include "compiler.h"
+#include "wheel_speed.h"
+#include "speed_control.h"
+#include "motion.h"
+#include "odometry.h"
+#include "crc.h"
+#include "telemetry.h"
+#include "shell.h"
+#include "format.h"
+#include "flashjob.h"
+#include "kvstore.h"
+#include "runlog.h"
+#include "persist.h"
 //
 //
 //
 extern   FLASH_data_t   FLASH_data;
-extern   FLASH_data_t   FLASH_data_image;
 extern   uint16_t       FLASH_SEQ_0[256];
 //
 // extern definitions to global variables
 //
+extern  uint8_t          left_wheel_threshold, right_wheel_threshold;
 extern  uint16_t         gRight_Speed, gLeft_Speed, current_right_speed, current_left_speed, current_speed;
 extern  uint8_t          left_PWM, right_PWM, new_left_PWM, new_right_PWM;
 extern  uint16_t         left_motor_state, right_motor_state;
+extern  uint8_t          left_motor_pwm, right_motor_pwm;
 extern  vehicle_state_t  state_of_vehicle;
 extern  uint16_t         straight_line_speed, turn_speed;
 extern  uint8_t          pwm_differential;
@@ -69,7 +82,6 @@ extern  uint8_t          left_motor_tweak, right_motor_tweak;
 extern  uint16_t    tick_count_16;
 extern  uint8_t     tick_count_8; 
 extern  uint8_t     second_count;   
-extern  uint8_t     tick_for_second_count;
 
 extern  uint8_t     debounced_state;    // switch debounce variables
 extern  uint8_t     switch_A, switch_B, switch_C, switch_D, switch_ABCD;
@@ -79,12 +91,12 @@ extern  uint8_t     LED_image, display_image, swap_image, LED_flash_map, display
 
 extern  uint16_t    left_wheel_count, right_wheel_count;
 extern  uint8_t     left_wheel_sensor_value, right_wheel_sensor_value;
-extern  uint8_t     left_speed_index, right_speed_index;
-extern  uint16_t    left_speed_array[64], right_speed_array[64];
 
 //extern  char ubasic_program_space[128];
 
-extern  seven_seg_display_t    robot_display;
+extern  const seven_seg_display_t            *display_front;
+extern  const seven_seg_display_t *volatile  display_next;
+extern  uint8_t                              display_char_ptr, display_shift_count;
 extern  const uint8_t          seven_segment_codes[];
 
 extern  seven_seg_display_t  intro;
@@ -166,6 +178,14 @@ extern union {
 		uint8_t uint8[RAM_SEQUENCE_SIZE * 2];
 	} RAM_sequence;
 	
+	// BASIC compiler workspace : sequence output followed by compiler tables
+	struct {
+		uint16_t sequence[RAM_SEQUENCE_SIZE];
+		uint8_t  line_table[MAX_COMPILE_LINES][2];     // line number, address
+		uint8_t  fixups[MAX_COMPILE_FIXUPS][2];        // GOTO address, line number
+		uint8_t  for_stack[MAX_COMPILE_FORS][2];       // variable, loop address
+	} compile;
+	
 } shared;
 
 
@@ -23,14 +23,21 @@ typedef enum {CMD_FORWARD = 10, CMD_BACKWARD, CMD_SPIN_LEFT, CMD_SPIN_RIGHT, CMD
 
 typedef enum { PUSH_16, PUSH_L8, PUSH_H8, POP_8, POP_16, SET_PARAMETER, 
        COMPUTE, GOTO, EXECUTE, DEC_AND_SKIP, TEST_AND_SKIP, READ_CHAN, EXIT, DELAY,
+       DRIVE,
 } instruction_t;
 
 enum { SPEED, DISTANCE, TIME, };
-enum { ADD, };
+enum { ADD, SUB, AND, OR, };
 enum { MOVE_TIME, MOVE_DISTANCE, START, STOP };
 enum { EQ, LT, GT };
 enum { NO, YES };
     
+//
+// stack machine resources
+//
+#define    STACK_SIZE        8         // number of 16-bit elements on the stack
+#define    NOS_VARIABLES    16
+
 //
 // instruction modifiers
 //
@@ -38,6 +45,7 @@ enum { NO, YES };
 #define   IMMEDIATE    0
 #define   REGISTER     1
 #define   STACK        2
+#define   TICK_COUNT   3         // DELAY data in 8mS ticks
 
 #define   ABSOLUTE           0
 #define   RELATIVE_PLUS      1
@@ -45,6 +53,18 @@ enum { NO, YES };
 
 #define   NO_DATA      0
 
+//
+// READ_CHAN channels above the a/d channels return the odometry pose
+//
+#define   POSE_X_CHAN         20       // cm from start point (16-bit signed)
+#define   POSE_Y_CHAN         21       // cm to the left of start point
+#define   POSE_HEADING_CHAN   22       // degrees anticlockwise (0 -> 359)
+
+//
+// DRIVE data : motor states packed as 2-bit motor_state_t values
+//
+#define   DRIVE_STATES(LEFT, RIGHT)    (((LEFT) & 0x03) | (((RIGHT) & 0x03) << 2))
+
 //
 // definition of variable addresses
 //
@@ -57,6 +77,9 @@ enum {V0, V1, V2, V3, V4, V5, V6, V7, V8, V9, V10, V11, V12, V13, V14, V15 };  /
 //              DECSKIP, CALC, TESTSKIP
 //} COMMAND;
 
+extern  uint8_t           sequence_running;
+extern  volatile uint8_t  sequence_abort;
+
 //----------------------------------------------------------------------------
 // prototypes
 //
@@ -64,6 +87,7 @@ void init_for_sequence_execution(void);
 void cmd_push_L8(uint8_t value);
 void cmd_push_H8(uint8_t value);
 void cmd_push_16(uint16_t value);
+void cmd_read_channel(uint8_t channel);
 uint8_t cmd_pop_8(void);
 uint16_t cmd_pop_16(void);
 void run_sequence(uint16_t  sequence[]);
@@ -73,5 +97,6 @@ void store_instruction(uint16_t sequence[],
                           uint8_t modifier, 
                           uint8_t data);
 void decode_command(uint16_t command); 
+uint8_t verify_sequence(const uint16_t sequence[], uint16_t length);
 
 #endif /* __interpreter_H */
\ No newline at end of file
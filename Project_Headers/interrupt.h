@@ -13,8 +13,77 @@
 #ifndef __interrupt_H
 #define __interrupt_H 
 
+//
+// background task table entry
+//
+typedef struct {
+    void      (*task)(void);
+    uint8_t   period;           // run every "period" 8mS ticks
+    uint8_t   phase;            // tick offset of first run
+} task_t;
+
+#define     NOS_TASKS       12
+
+extern  const task_t    task_table[NOS_TASKS];
+#if ISR_TIMING
+extern  uint16_t        task_wcet[NOS_TASKS];
+#endif
+
+//
+// switch edge events
+//
+typedef struct {
+    uint8_t   event;            // switch_n_MASK | SWITCH_PRESS or SWITCH_RELEASE
+    uint16_t  time;             // tick_count_16 at debounced edge
+} switch_event_t;
+
+#define     SWITCH_PRESS            0x00
+#define     SWITCH_RELEASE          0x80
+#define     SWITCH_EVENT_QUEUE_SIZE 8       // must be a power of 2
+
+extern  uint8_t     switch_event_overflows;     // counted only inside wait_switch
+
+void init_switches(void);
+uint8_t get_switch_event(switch_event_t *event);
+void flush_switch_events(void);
+void wait_switch(uint8_t mask, uint8_t state);
+
+//
+// ISR execution time statistics (times in bus clocks)
+//
+typedef enum {TIMED_IRQ, TIMED_KBI, TIMED_RTI, TIMED_ADC, TIMED_SCI_TX, TIMED_SCI_RX, NOS_TIMED_ISRS} timed_isr_t;
+
+#define     ISR_HISTOGRAM_BINS      8
+#define     ISR_HISTOGRAM_BASE      100     // first bin < 100 clocks (5uS), then doubling
+#define     TIMING_OVERRUN          0xFFFF  // time of one TPM1 period (200uS) or more
+
+typedef struct {
+    uint16_t  min, max;                 // max = TIMING_OVERRUN after an overrun
+    uint32_t  total;
+    uint16_t  count;
+    uint16_t  overruns;                 // times too long to measure
+    uint16_t  histogram[ISR_HISTOGRAM_BINS];
+} isr_stats_t;
+
+#if ISR_TIMING
+extern  isr_stats_t     isr_stats[NOS_TIMED_ISRS];
+extern  uint32_t        isr_busy_last_second;
+
+#define     ISR_ENTRY(start)            (start) = isr_timing_start()
+#define     ISR_EXIT(isr, start)        isr_timing_end((isr), (start))
+#else
+#define     ISR_ENTRY(start)
+#define     ISR_EXIT(isr, start)
+#endif
+
+uint16_t isr_timing_start(void);
+void isr_timing_end(uint8_t isr, uint16_t start);
+void reset_isr_stats(void);
+
 void irq_isr(void);
 void rti_isr(void);
 void kbi_isr(void);
+void init_tasks(void);
+void rti_catch_up(uint8_t ticks);
 
 #endif /* __interrupt_H */
\ No newline at end of file
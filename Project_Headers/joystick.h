@@ -11,6 +11,15 @@ uint8_t run_joystick_mode(void);
 void run_joystick_mode_1(void);
 void run_joystick_mode_2(void);
 void run_joystick_mode_3(void);
+void run_joystick_mode_4(void);
+void run_joystick_mode_5(void);
+void drive_joystick_mode_1(uint8_t record);
+void record_start(void);
+uint8_t record_word(uint8_t inst, uint8_t modifier, uint8_t data);
+uint8_t record_delay(void);
+uint8_t record_change(uint8_t states);
+uint8_t record_speeds(void);
+void record_end(void);
 
 
 
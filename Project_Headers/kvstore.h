@@ -0,0 +1,36 @@
+//----------------------------------------------------------------------------
+// kvstore.h
+// =========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __kvstore_H
+#define __kvstore_H
+
+#define     KV_NOS_PAGES            2
+#define     KV_RECORD_SIZE          4       // page header is the same size
+#define     KV_RECORDS_PER_PAGE     ((PAGE_SIZE / KV_RECORD_SIZE) - 1)
+#define     KV_MAX_KEYS             8       // keys are 1 -> KV_MAX_KEYS
+//
+// keys
+//
+#define     KV_LEFT_WHEEL_THRESHOLD     1
+#define     KV_RIGHT_WHEEL_THRESHOLD    2
+#define     KV_SEQ_0_CRC                3
+#define     KV_SEQ_0_VERSION            4
+//
+// Error codes, in addition to the FLASH_ERR_xxx codes
+//
+#define     KV_OK                   FLASH_OK
+#define     KV_ERR_NOT_FOUND        0x04
+#define     KV_ERR_KEY              0x08
+
+extern  uint16_t    kv_erase_count;
+extern  uint8_t     kv_bad_records;
+
+void kv_init(void);
+uint8_t kv_read(uint8_t key, uint16_t *value);
+uint8_t kv_write(uint8_t key, uint16_t value);
+uint8_t kv_free(void);
+
+#endif /* __kvstore_H */
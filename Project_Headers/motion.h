@@ -0,0 +1,52 @@
+//----------------------------------------------------------------------------
+// motion.h
+// ========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __motion_H
+#define __motion_H
+
+#define     MOVE_ACCELERATION       400     // mm/S/S
+#define     MOVE_MIN_SPEED          40      // mm/S, creep speed at end of move
+#define     MOVE_MM_PER_PERCENT     5       // mm/S for 1% of PWM speed setting
+#define     MOVE_STALL_TICKS        125     // no encoder count for 1 second = stalled
+#define     MOVE_QUEUE_SIZE         8       // queued moves after the current one
+//
+// speed change per profile update (PID_PERIOD ticks)
+//
+#define     MOVE_SPEED_STEP         ((MOVE_ACCELERATION * PID_PERIOD * TICK_TIME_IN_MS) / 1000)
+//
+// deceleration given by the rounded speed step (mm/S/S)
+//
+#define     MOVE_DECELERATION       ((MOVE_SPEED_STEP * 1000UL) / (PID_PERIOD * TICK_TIME_IN_MS))
+//
+// difference in wheel travel (mm) for one full turn : 2.pi.wheel_base, 2.pi ~ 44/7
+//
+#define     MOVE_TURN_MM            ((WHEEL_BASE_MM * 44UL) / 7)
+
+typedef enum {MOVE_IDLE, MOVE_ACCELERATE, MOVE_CRUISE, MOVE_DECELERATE, MOVE_STALLED} move_phase_t;
+
+typedef enum {MOVE_BY_TIME, MOVE_BY_DISTANCE, MOVE_BY_ANGLE} move_type_t;
+
+typedef struct {
+    move_type_t   type;
+    uint16_t      limit;            // 8mS ticks, encoder counts or degrees
+    motor_t       unit;             // wheel used for MOVE_BY_DISTANCE counts
+    int8_t        l_speed;          // -100% -> 100%
+    int8_t        r_speed;
+} move_cmd_t;
+
+extern  volatile uint8_t   move_queue_empty;
+
+uint8_t move_enqueue(const move_cmd_t *cmd);
+uint8_t move_queue_time(uint16_t ticks, int8_t l_speed, int8_t r_speed);
+uint8_t move_queue_distance(uint16_t encoder_counts, motor_t unit, int8_t l_speed, int8_t r_speed);
+uint8_t move_queue_angle(uint16_t degrees, int8_t l_speed, int8_t r_speed);
+void move_flush(void);
+uint8_t move_done(void);
+void move_abort(void);
+move_phase_t move_phase(void);
+void move_task(void);
+
+#endif /* __motion_H */
@@ -0,0 +1,39 @@
+//----------------------------------------------------------------------------
+// odometry.h
+// ==========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __odometry_H
+#define __odometry_H
+
+//
+// distance for half an encoder count in mm x 256 (Q8.8)
+//
+#define     ODO_HALF_COUNT_MM_Q8    ((uint16_t)((256000UL + WHEEL_CONSTANT) / (2 * WHEEL_CONSTANT)))
+//
+// heading change for one count on one wheel, in binary angle units
+// (65536 = 360 degrees) : count_mm / (2.pi.wheel_base), 2.pi ~ 44/7
+//
+#define     ODO_ANGLE_PER_COUNT     ((uint16_t)((65536000UL * 7) / ((uint32_t)WHEEL_CONSTANT * 44 * WHEEL_BASE_MM)))
+
+#define     SIN_TABLE_SIZE          65      // 0 -> 90 degrees in 64 steps
+#define     ANGLE_90                0x4000
+
+typedef struct {
+    int32_t   x, y;             // mm x 256 (Q24.8), x = initial direction of travel
+    uint16_t  heading;          // binary angle, anticlockwise from initial direction
+} pose_t;
+
+extern  pose_t  pose;
+
+void reset_pose(void);
+void odometry_update(void);
+void get_pose(pose_t *current);
+int16_t pose_x_cm(void);
+int16_t pose_y_cm(void);
+uint16_t pose_heading_deg(void);
+int16_t sin_q14(uint16_t angle);
+int16_t cos_q14(uint16_t angle);
+
+#endif /* __odometry_H */
@@ -0,0 +1,26 @@
+//----------------------------------------------------------------------------
+// persist.h
+// =========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __persist_H
+#define __persist_H
+
+#define     SEQUENCE_FORMAT_VERSION     1   // change if the instruction format changes
+//
+// where persistent data was loaded from
+//
+typedef enum {
+    PERSIST_OK,                         // verified
+    PERSIST_LEGACY,                     // saved before CRC headers, not verified
+    PERSIST_DEFAULT                     // missing or corrupt, compiled-in default used
+} persist_state_t;
+
+extern  uint8_t     persist_thresholds, persist_sequence_0;
+
+void persist_load(void);
+void persist_report(void);
+uint8_t persist_sequence_saved(void);
+
+#endif /* __persist_H */
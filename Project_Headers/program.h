@@ -19,7 +19,7 @@ uint8_t play_sequence(void);
 uint8_t dump_strips(void);
 uint8_t input_timed_sequence(void);
 uint8_t input_distance_sequence(void);
-void save_sequence(uint8_t flash_seq_no);
+uint8_t save_sequence(uint8_t flash_seq_no);
 void load_sequence(uint8_t flash_seq_no);
 void dump_sequence(void);
 uint8_t get_basic_program(void);
@@ -0,0 +1,48 @@
+//----------------------------------------------------------------------------
+// runlog.h
+// ========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __runlog_H
+#define __runlog_H
+
+#define     RUNLOG_NOS_PAGES        4
+#define     RUNLOG_RECORD_SIZE      8
+#define     RUNLOG_BUFFER_RECORDS   8           // RAM buffer, must be a power of 2
+//
+// event codes
+//
+typedef enum {
+    RUNLOG_RUN_START = 1,               // data = RUNLOG_ID(mode, activity)
+    RUNLOG_RUN_END,
+    RUNLOG_MOTORS,                      // motor state change
+    RUNLOG_BUMP,                        // data = front sensors that bumped
+    RUNLOG_USER,                        // first free code for experiments
+    RUNLOG_PAGE = 0xFE                  // page header (not a logged event)
+} runlog_event_t;
+
+#define     RUNLOG_ID(mode, activity)   ((uint8_t)(((mode) << 4) | ((activity) & 0x0F)))
+//
+// record as held in RAM and flash
+//
+typedef struct {
+    uint8_t     event;
+    uint8_t     data;
+    uint16_t    delta;                  // ticks since previous record (page sequence in header)
+    uint8_t     motors;                 // left state << 4 | right state
+    uint8_t     sensor[3];              // front left, centre, right (header : CRC high, low, magic)
+} runlog_record_t;
+
+extern  uint16_t    runlog_dropped;
+extern  uint8_t     runlog_bad_pages;
+
+void runlog_init(void);
+void runlog_start(uint8_t run_id);
+void runlog_stop(void);
+void runlog_event(uint8_t event, uint8_t data);
+void runlog_idle(void);
+void runlog_flush(void);
+void runlog_dump(void);
+
+#endif /* __runlog_H */
@@ -2,6 +2,26 @@
 #ifndef __sci_H
 #define __sci_H
 
+#define     SCI_TX_BUFFER_SIZE      64      // must be a power of 2
+#define     SCI_RX_BUFFER_SIZE      64      // must be a power of 2
+#define     SCI_FRAME_SIZE          40      // largest frame for sci_send_frame
+#define     SCI_LINE_SIZE           32      // longest line + terminating NUL
+#define     SCI_NO_LINE             0xFF
+#define     SCI_READ_TIMEOUT_MS     5000    // read_string wait for a line
+
+typedef enum {SCI_DROP, SCI_BLOCK} sci_overflow_t;
+
+extern  uint16_t    sci_tx_dropped;
+extern  uint16_t    sci_rx_overruns, sci_rx_framing_errors, sci_rx_overflows;
+
+extern uint8_t sci_write(const char *data, uint8_t length, sci_overflow_t policy);
+extern uint8_t sci_tx_space(void);
+extern uint8_t sci_send_frame(const uint8_t *frame, uint8_t length);
+extern void sci_flush(void);
+extern void sci_tx_isr(void);
+extern void sci_rx_isr(void);
+extern uint8_t sci_readline(char line[], uint8_t size);
+extern uint8_t sci_rx_ready(void);
 
 extern void sci_tx_byte(char s_char);
 extern char sci_rx_byte(void);
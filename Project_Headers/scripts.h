@@ -10,6 +10,7 @@
 
 extern const char script_example[];
 extern const char script1[];
+extern const char script2[];
 
 
 #endif /* SCRIPTS_H_ */
@@ -0,0 +1,36 @@
+//----------------------------------------------------------------------------
+// shell.h
+// =======
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __shell_H
+#define __shell_H
+
+#define     SHELL_MAX_ARGS      6           // command name + 5 arguments
+//
+// command results
+//
+#define     SHELL_OK            0
+#define     SHELL_BAD_ARGS      1
+#define     SHELL_BUSY          2
+#define     SHELL_FAILED        3
+#define     SHELL_REPLIED       4           // handler has already sent "OK"
+//
+// command flags
+//
+#define     SHELL_ANY_TIME      0x01        // may run while a mode or sequence is active
+
+typedef uint8_t (*shell_handler_t)(uint8_t argc, char *argv[]);
+
+typedef struct {
+    const char       *name;
+    shell_handler_t  handler;
+    uint8_t          min_args;              // arguments after the name
+    uint8_t          flags;
+    const char       *help;
+} shell_command_t;
+
+void shell_poll(void);
+
+#endif /* __shell_H */
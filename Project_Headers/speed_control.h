@@ -0,0 +1,53 @@
+//----------------------------------------------------------------------------
+// speed_control.h
+// ===============
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __speed_control_H
+#define __speed_control_H
+
+#ifdef HOST_SIM
+#include <stdint.h>
+#endif
+
+#define     PID_PERIOD          4       // ticks between controller updates (32mS)
+//
+// gains are scaled by 256 (Q8), output is in % PWM x 256
+//
+#ifndef PID_KFF
+#define     PID_KFF             48      // feed forward : 0.19% per mm/S of target
+#endif
+#ifndef PID_KP
+#define     PID_KP              30      // proportional : 0.12% per mm/S of error
+#endif
+#ifndef PID_KI
+#define     PID_KI              3       // integral     : 0.012% per mm/S of error per update
+#endif
+#ifndef PID_KD
+#define     PID_KD              8       // derivative   : 0.03% per mm/S change of error
+#endif
+#ifndef PID_KC
+#define     PID_KC              4       // cross coupling : mm/S of correction per count of difference
+#endif
+
+#define     PID_OUT_MAX         (100 * 256)
+#define     PID_I_LIMIT         (50 * 256)  // integral term limited to +/-50%
+#define     PID_CROSS_LIMIT     16          // counts of wheel difference used for cross coupling
+
+typedef struct {
+    int16_t   i_term;           // integral term, % x 256
+    int16_t   last_error;       // mm/S
+} wheel_pid_t;
+
+void wheel_pid_reset(wheel_pid_t *pid);
+uint8_t wheel_pid_step(wheel_pid_t *pid, uint16_t target, int16_t error);
+
+#ifndef HOST_SIM
+void set_wheel_speed(int16_t left, int16_t right);
+void set_wheel_targets(int16_t left, int16_t right);
+void speed_control_off(void);
+void speed_control_task(void);
+#endif
+
+#endif /* __speed_control_H */
@@ -30,6 +30,7 @@
 //----------------------------------------------------------------------------
 //
 #define     PAGE_SIZE           512       // 512 bytes per page (0x200)
+#define     ROW_SIZE            64        // 64 byte rows within a page (burst programming)
 
 //----------------------------------------------------------------------------
 // Chip configuration registers
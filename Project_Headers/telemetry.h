@@ -0,0 +1,63 @@
+//----------------------------------------------------------------------------
+// telemetry.h
+// ===========
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __telemetry_H
+#define __telemetry_H
+
+#ifdef HOST_SIM
+#include <stdint.h>
+#define     NOS_ADC_CHANNELS        14      // as adc.h
+#endif
+
+#define     TELEMETRY_SNAPSHOT      0x01    // frame type byte
+//
+// snapshot layout (multi-byte values little endian), shared with
+// Host_Files/telemetry_decode.c
+//
+//      0       frame type
+//      1       sequence number
+//      2-3     tick_count_16
+//      4-17    a/d channels 0 -> 13 (8-bit)
+//      18-19   left wheel count
+//      20-21   right wheel count
+//      22-23   left wheel speed (mm/S)
+//      24-25   right wheel speed (mm/S)
+//      26      motor states (left | right << 2)
+//      27      left motor PWM %
+//      28      right motor PWM %
+//      29      switch bits (debounced, active low)
+//      30-31   CRC-16/CCITT of bytes 0 -> 29
+//
+#define     TELEMETRY_TYPE          0
+#define     TELEMETRY_SEQUENCE      1
+#define     TELEMETRY_TICKS         2
+#define     TELEMETRY_ADC           4
+#define     TELEMETRY_LEFT_COUNT    (TELEMETRY_ADC + NOS_ADC_CHANNELS)
+#define     TELEMETRY_RIGHT_COUNT   (TELEMETRY_LEFT_COUNT + 2)
+#define     TELEMETRY_LEFT_SPEED    (TELEMETRY_RIGHT_COUNT + 2)
+#define     TELEMETRY_RIGHT_SPEED   (TELEMETRY_LEFT_SPEED + 2)
+#define     TELEMETRY_MOTOR_STATES  (TELEMETRY_RIGHT_SPEED + 2)
+#define     TELEMETRY_LEFT_PWM      (TELEMETRY_MOTOR_STATES + 1)
+#define     TELEMETRY_RIGHT_PWM     (TELEMETRY_LEFT_PWM + 1)
+#define     TELEMETRY_SWITCHES      (TELEMETRY_RIGHT_PWM + 1)
+#define     TELEMETRY_PAYLOAD_SIZE  (TELEMETRY_SWITCHES + 1)
+#define     TELEMETRY_RAW_SIZE      (TELEMETRY_PAYLOAD_SIZE + 2)
+//
+// COBS adds one byte per 254 plus a 0x00 delimiter each end
+//
+#define     TELEMETRY_FRAME_SIZE    (TELEMETRY_RAW_SIZE + 3)
+
+#ifndef HOST_SIM
+extern  uint16_t    telemetry_frames_sent, telemetry_frames_dropped;
+
+void telemetry_start(uint8_t period);
+void telemetry_stop(void);
+uint8_t telemetry_period(void);
+void telemetry_task(void);
+uint8_t cobs_encode(const uint8_t *in, uint8_t length, uint8_t *out);
+#endif /* HOST_SIM */
+
+#endif /* __telemetry_H */
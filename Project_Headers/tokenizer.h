@@ -80,7 +80,7 @@ enum {
 void tokenizer_init(const char *program);
 void tokenizer_next(void);
 uint8_t tokenizer_token(void);
-uint8_t tokenizer_num(void);
+int16_t tokenizer_num(void);
 uint8_t tokenizer_variable_num(void);
 void tokenizer_string(char *dest, uint8_t len);
 
@@ -15,9 +15,10 @@ uint8_t get_random_bit(void);
 uint8_t get_random_byte(void);
 void disable_wheel_count(void);
 void enable_wheel_count(void);
-uint8_t  update_PID(int8_t error, int8_t old_error); 
 void set_vehicle_state(void);
+void set_motors(motor_state_t left_state, uint8_t left_pct, motor_state_t right_state, uint8_t right_pct);
 void set_motor(motor_t unit, motor_state_t state, uint8_t pwm_width);
+void run_mode(sys_modes_t mode);
 void vehicle_stop(void);
 int16_t abs16(int16_t  value);
 void self_test(void);
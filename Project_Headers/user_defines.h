@@ -43,8 +43,8 @@
 //
 // macros to read debounced switch states
 //
-#define     WAIT_SWITCH_RELEASED(switch_n)      while((switch_n) == PRESSED);
-#define     WAIT_SWITCH_PRESSED(switch_n)       while((switch_n) == RELEASED);
+#define     WAIT_SWITCH_RELEASED(switch_n)      wait_switch(switch_n##_MASK, RELEASED);
+#define     WAIT_SWITCH_PRESSED(switch_n)       wait_switch(switch_n##_MASK, PRESSED);
 #define     WAIT_ANY_SWITCH_PRESSED             while(switch_ABCD == ALL_RELEASED);
 #define     WAIT_ALL_SWITCHES_RELEASED          while(switch_ABCD != ALL_RELEASED);
 #define     PROMPT_SWITCH_A    set_LED(LED_A, FLASH_ON);WAIT_SWITCH_PRESSED(switch_A);WAIT_SWITCH_RELEASED(switch_A);clr_LED(LED_A);
@@ -73,10 +73,17 @@
 
 #define  DISABLE_INTERRUPTS       { asm sei;}
 #define  ENABLE_INTERRUPTS        { asm cli;}
+//
+// critical section that leaves the interrupt mask as it was found : safe
+// in an interrupt routine or with interrupts masked. "ccr" is a uint8_t
+// local variable of the caller.
+//
+#define  SAVE_INTERRUPTS(ccr)     { asm TPA; asm STA ccr; asm SEI; }
+#define  RESTORE_INTERRUPTS(ccr)  { asm LDA ccr; asm TAP; }
 
 #define  CLEAR_AD_WHEEL_COUNTERS  { asm sei; left_wheel_count = 0; right_wheel_count = 0; asm cli; }
 
-#define  INSTRUCTION(OP_CODE, MODIFIER, DATA)  ((((OP_CODE)<<8)&0x3F00) | (((MODIFIER)<<8)&0xC000) | (((DATA))&0x00FF))    
+#define  INSTRUCTION(OP_CODE, MODIFIER, DATA)  ((((OP_CODE)<<8)&0x3F00) | (((MODIFIER)<<14)&0xC000) | (((DATA))&0x00FF))    
 
 //----------------------------------------------------------------------------
 // commands from reading strip scans
@@ -104,6 +111,8 @@
 //
 #define     PWM_FREQ    5000                // PWM set to 5kHz for motors
 #define     PWM_COUNT   (BUSCLK/PWM_FREQ)   // main PWM count to give PWM_FREQ
+#define     PWM_DUTY(pct)   ((PWM_COUNT/100) * (100 - (pct)))   // compare value for pct% speed
+#define     MOTOR_PWM_UNKNOWN   0xFF        // motor setting not yet written
 
 #define     TICK_TIME_IN_MS          8
 #define     TICKS_IN_ONE_SECOND    (1000/TICK_TIME_IN_MS)
@@ -145,7 +154,13 @@
 #define     NO_LINE                    60
 #define     BLACK_WHITE_THRESHOLD     120     // lower for white, higher for black
 
-#define     SWITCH_SAMPLES     3     // number of samples to debounce push switches
+
+#define     ISR_TIMING         0     // 1 = measure ISR and RTI task execution times, 0 = remove
+#define     TELEMETRY_DEFAULT_PERIOD  0   // ticks between telemetry frames at start-up, 0 = off
+
+#define     ADC_10BIT          1     // 1 = 10-bit conversions, 0 = 8-bit
+#define     ADC_OVERSAMPLE     4     // conversions averaged per channel per scan (1 to 16)
+#define     ADC_EMA_SHIFT      2     // exponential average weight of new sample = 1/(2^shift)
 
 #define     DEFAULT_SPEED             60    // 60% full speed
 #define     DEFAULT_LINE_BUMP_SPEED   60    // %
@@ -183,6 +198,7 @@
 #define   TEMP_STRING_SIZE             30
 
 #define   WHEEL_SENSOR_CALIBRATE_SPEED     35
+#define   WHEEL_THRESHOLD_DEFAULT          128     // used if no valid calibration
 #define   NOS_WHEEL_SENSOR_CALIBRATE_READINGS          250
 #define   V_MAX_VALUE    255
 #define   V_MIN_VALUE      0
@@ -198,17 +214,11 @@
 #define     PULSES_BACKWARD     16
 
 #define     WHEEL_CONSTANT     153     // 1.53 pulses/cm
+#define     WHEEL_BASE_MM      133     // distance between wheel centres
 
 //----------------------------------------------------------------------------
-// PID values
+// PID values (wheel speed gains are in speed_control.h)
 //
-#define     I_MAX             10
-#define     I_MIN              0
-
-#define     P_GAIN_DEFAULT    40
-#define     I_GAIN_DEFAULT     3
-#define     D_GAIN_DEFAULT     2
-
 #define     E_GAIN_DEFAULT    10
      
 //----------------------------------------------------------------------------
@@ -217,6 +227,13 @@
 #define     PRESSED        0
 #define     RELEASED       1
 #define     ALL_RELEASED   0b00111100 
+//
+// port C bit of each switch (names match the switch_n variables for the WAIT_ macros)
+//
+#define     switch_A_MASK  0b00000100
+#define     switch_B_MASK  0b00001000
+#define     switch_C_MASK  0b00100000
+#define     switch_D_MASK  0b00010000
 
 //----------------------------------------------------------------------------
 // error codes
@@ -318,11 +335,11 @@ typedef enum {
 #define   EXPERIMENT_MODE_CODE   'E'
 
 typedef enum 
-    { JOYSTICK_MODE_1, JOYSTICK_MODE_2, JOYSTICK_MODE_3
+    { JOYSTICK_MODE_1, JOYSTICK_MODE_2, JOYSTICK_MODE_3, JOYSTICK_MODE_4, JOYSTICK_MODE_5
 } joystick_mode_t;
 
 #define   FIRST_JOYSTICK_MODE  JOYSTICK_MODE_1
-#define   LAST_JOYSTICK_MODE   JOYSTICK_MODE_3
+#define   LAST_JOYSTICK_MODE   JOYSTICK_MODE_5
 
 typedef enum 
     { RUN_FORWARD, RUN_BACKWARD, RUN_SPIN_RIGHT, RUN_SPIN_LEFT, RUN_TEST,  DEMO_MODE
@@ -387,9 +404,16 @@ typedef enum
 } experiment_mode_t;
 
 #define   FIRST_EXPERIMENT_MODE  CYCLE_DISPLAYS
-#define   LAST_EXPERIMENT_MODE   9
+#define   LAST_EXPERIMENT_MODE   12
+
 
+#define   RAM_SEQUENCE_SIZE    256       // one FLASH page
 
-#define   RAM_SEQUENCE_SIZE    100
+//
+// BASIC to sequence compiler tables (held in the shared RAM area)
+//
+#define   MAX_COMPILE_LINES    64
+#define   MAX_COMPILE_FIXUPS   24
+#define   MAX_COMPILE_FORS     4
 
 #endif
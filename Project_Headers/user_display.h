@@ -136,7 +136,8 @@ void show_dual_chars(char B_char, char A_char, uint8_t mode);
 void show_char(uint8_t segment_no, uint8_t char_code, uint8_t flash_mode); 
 //void display_char(uint8_t  char_code, uint8_t flash_mode);
 void display_string(char *string, uint8_t mode);
-void load_display(seven_seg_display_t   *display_struct);
+void load_display(const seven_seg_display_t   *display_struct);
+void display_show(const seven_seg_display_t *frame);
 void set_seg_bar(uint8_t  bar_code, uint8_t flash_mode);
 void clr_seg_bar(uint8_t  bar_code, uint8_t flash_mode);
 void set_LED(uint8_t  LED_code, uint8_t flash_mode);
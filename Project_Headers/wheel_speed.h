@@ -0,0 +1,36 @@
+//----------------------------------------------------------------------------
+// wheel_speed.h
+// =============
+//
+//----------------------------------------------------------------------------
+//
+#ifndef __wheel_speed_H
+#define __wheel_speed_H
+
+#define     WHEEL_EDGE_HISTORY      8       // edge times kept per wheel (power of 2)
+#define     WHEEL_SPEED_HISTORY     16      // speed samples kept per wheel (power of 2)
+#define     WHEEL_SPEED_SAMPLE      8       // ticks between speed samples (64mS)
+#define     WHEEL_SPEED_WINDOW      32      // longest span of edges used (256mS)
+#define     WHEEL_STOP_TICKS        64      // no edge for this long = stopped (0.5S)
+//
+// mm/S for one encoder edge per tick
+//
+#define     WHEEL_SPEED_K           ((uint16_t)((TICKS_IN_ONE_SECOND * 1000UL) / WHEEL_CONSTANT))
+
+typedef struct {
+    uint16_t  edge_time[WHEEL_EDGE_HISTORY];    // wheel_speed_ticks at each edge
+    uint8_t   edge_index;                       // next edge_time entry
+    uint8_t   edges;                            // valid edge_time entries
+    uint16_t  count;                            // total edges (not cleared by modes)
+    uint16_t  speed;                            // mm/S
+    uint16_t  history[WHEEL_SPEED_HISTORY];     // speed every WHEEL_SPEED_SAMPLE ticks
+    uint8_t   history_index;                    // next history entry
+} wheel_speed_t;
+
+extern  wheel_speed_t   wheel_speed[2];
+
+void init_wheel_speed(void);
+void wheel_speed_update(uint8_t left_edge, uint8_t right_edge);
+uint16_t get_wheel_speed(motor_t wheel);
+
+#endif /* __wheel_speed_H */
@@ -122,7 +122,7 @@ uint8_t do_move(uint8_t direction) {
 
 uint16_t   forward_time, temp16;
 uint8_t    ad_value, speed;
-int8_t     speed_differential;
+int8_t     speed_differential, l_speed, r_speed;
 
     set_LED(LED_A, FLASH_ON); 
     set_LED(LED_B, FLASH_ON);
@@ -143,26 +143,26 @@ int8_t     speed_differential;
             DelayMs(1000);
             play_tune(&snd_beeps_1);
             
+            l_speed = (int8_t)gLeft_Speed;
+            r_speed = (int8_t)gRight_Speed;
             switch (direction) {
                 case FORWARD :
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
                     break; 
                 case BACKWARD :
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed); 
+                    l_speed = -l_speed;
+                    r_speed = -r_speed;
                     break; 
                 case SPIN_RIGHT :
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed); 
+                    r_speed = -r_speed;
                     break; 
                 case SPIN_LEFT :
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed); 
+                    l_speed = -l_speed;
                     break; 
             }
-
-            DelayMs(forward_time);
+            move_queue_time(forward_time / TICK_TIME_IN_MS, l_speed, r_speed);
+            while (move_done() == 0) {
+                ;
+            }
                           
             vehicle_stop();
             stop_tune();                  
@@ -307,8 +307,7 @@ uint16_t    left_count, right_count, start_time, now_time;
 // start both motors
 //            
             DelayMs(1000);  
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+            set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
 //
 // stop motors on the following conditions
 //  a. either line sensor detects black
@@ -316,8 +315,7 @@ uint16_t    left_count, right_count, start_time, now_time;
 //
             now_time = tick_count_16;
             if ((now_time - start_time) > MOTOR_TEST_TIME_OUT) {
-                set_motor(LEFT_MOTOR, MOTOR_BRAKE, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BRAKE, gRight_Speed);
+                set_motors(MOTOR_BRAKE, gLeft_Speed, MOTOR_BRAKE, gRight_Speed);
                 sys_error = TIME_OUT; 
                 break;
             }
@@ -330,8 +328,7 @@ uint16_t    left_count, right_count, start_time, now_time;
 // check for line detection
 //
             if ((line_L > BLACK_WHITE_THRESHOLD) || (line_L > BLACK_WHITE_THRESHOLD)){
-                set_motor(LEFT_MOTOR, MOTOR_BRAKE, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BRAKE, gRight_Speed); 
+                set_motors(MOTOR_BRAKE, gLeft_Speed, MOTOR_BRAKE, gRight_Speed);
                 break;
             }                     
         }   
@@ -14,10 +14,130 @@
  * Author                Date          Comment
  *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * James Courtier        21/05/2008    Original.
+ * agent                 19/10/2026    Interrupt driven background scan,
+ *                                     oversampling and channel filters
  ************************************************************************/
 
 #include "global.h"
 
+//----------------------------------------------------------------------------
+// Background scan
+// ===============
+//
+// Description
+//      Each RTI tick "adc_start_scan" starts a conversion of channel 0.
+//      The conversion complete interrupt converts each channel ADC_OVERSAMPLE
+//      times, passes the mean through the channel's filter (see below) and
+//      starts the next channel until all NOS_ADC_CHANNELS have been done.
+//      The results go into one bank of "adc_value" (full resolution) and
+//      "adc_sample" (8-bit) while the other bank is read. At the end of the
+//      scan the banks swap, so every reader sees a complete set of readings
+//      taken within the same scan, at most one tick (8mS) old.
+//
+//      "adc_sequence" counts the samples made available for each channel
+//      (rolls over after 255) so that a caller can wait for a new value.
+//
+//      With an ADC clock of 2.5MHz each 10-bit conversion takes about 9uS,
+//      so a 4 times oversampled scan is finished in around 600uS of each
+//      8mS tick.
+//
+uint16_t  adc_value[2][NOS_ADC_CHANNELS];
+uint8_t   adc_sample[2][NOS_ADC_CHANNELS];
+uint8_t   adc_sequence[NOS_ADC_CHANNELS];
+uint8_t   adc_read_bank;                    // bank holding last complete scan
+uint8_t   adc_scan_channel;                 // channel converting, or ADC_SCAN_IDLE
+uint8_t   adc_oversample_count;
+uint16_t  adc_sum;
+
+//----------------------------------------------------------------------------
+// Bump watch
+// ==========
+//
+// Description
+//      Latches the first time any watched channel reads below a threshold
+//      so that modes test a flag rather than read and compare sensors.
+//
+//      During each scan the mean of every watched channel is compared in
+//      the a/d interrupt. Between scans the converter is left running
+//      continuously in hardware compare mode (ADC1SC2 ACFE) on one watched
+//      channel, rotating to the next watched channel each tick. In compare
+//      mode the conversion complete interrupt only occurs when a result is
+//      below ADC1CV, so watching costs no CPU time until a bump occurs.
+//
+//      The hardware compare acts on single unfiltered conversions.
+//
+bump_watch_t  bump_watch;
+uint16_t      bump_watch_mask;              // channels watched, 0 = off
+uint16_t      bump_watch_level;             // threshold at full resolution
+uint8_t       bump_watch_next;              // next channel for hardware compare
+
+static void bump_watch_latch(uint8_t chan);
+static void bump_watch_compare(void);
+
+//----------------------------------------------------------------------------
+// Channel filters
+// ===============
+//
+// Description
+//      Applied to the mean of the oversampled conversions of each scan.
+//          ADC_FILTER_NONE   : mean of this scan's conversions (boxcar
+//                              over ADC_OVERSAMPLE samples, no added lag)
+//          ADC_FILTER_EMA    : exponential moving average over scans, for
+//                              slowly changing inputs (battery, pots)
+//          ADC_FILTER_MEDIAN : median of the last 3 scans, removes single
+//                              scan spikes on the bump sensors at the cost
+//                              of one tick of delay
+//
+//      "adc_filter_state" holds the EMA (scaled by 16) in [0], or the two
+//      previous scan values for the median filter.
+//
+const adc_filter_t  adc_filter[NOS_ADC_CHANNELS] = {
+    ADC_FILTER_EMA,                                         // BATTERY_VOLTS
+    ADC_FILTER_EMA, ADC_FILTER_EMA, ADC_FILTER_EMA,         // POT_3, POT_2, POT_1
+    ADC_FILTER_NONE, ADC_FILTER_NONE,                       // PAD_SWL, PAD_SWR
+    ADC_FILTER_NONE, ADC_FILTER_NONE,                       // LINE_SENSOR_L/R
+    ADC_FILTER_MEDIAN, ADC_FILTER_MEDIAN, ADC_FILTER_MEDIAN,// FRONT_SENSOR_L/C/R
+    ADC_FILTER_NONE, ADC_FILTER_NONE,                       // WHEEL_SENSOR_L/R
+    ADC_FILTER_MEDIAN,                                      // REAR_SENSOR
+};
+
+uint16_t  adc_filter_state[NOS_ADC_CHANNELS][2];
+
+//----------------------------------------------------------------------------
+// filter_sample : apply channel filter to a new scan value
+// =============
+//
+static uint16_t filter_sample(uint8_t chan, uint16_t value) 
+{
+uint16_t   *state;
+uint16_t   a, b;
+
+    state = adc_filter_state[chan];
+    switch (adc_filter[chan]) {
+        case ADC_FILTER_EMA :
+            state[0] = state[0] - (state[0] >> ADC_EMA_SHIFT) + ((value << 4) >> ADC_EMA_SHIFT);
+            value = (state[0] + 8) >> 4;
+            break;
+        case ADC_FILTER_MEDIAN :
+            a = state[0];
+            b = state[1];
+            state[0] = b;
+            state[1] = value;
+            if (a > b) {
+                a ^= b; b ^= a; a ^= b;     // order so that a <= b
+            }
+            if (value < a) {
+                value = a;
+            } else if (value > b) {
+                value = b;
+            }
+            break;
+        default :
+            break;
+    }
+    return value;
+}
+
 //***********************************************************************
 //** Function:      get_adc
 //** Description:   Gets analogue value for selected channel
@@ -25,42 +145,290 @@
 //** Returns:       char      - ADC value
 //
 // Notes
-//      Protect from interrupts as an interrupt routine will
-//      want to access the analogue channels.
+//      Returns the value from the last complete background scan. Does not
+//      wait or disable interrupts so it can also be used inside interrupt
+//      routines.
 //
 //*********************************************************************** 
 uint8_t get_adc(a2d_channels_t chan) 
 {
-uint8_t   adc_value;
+    return adc_sample[adc_read_bank][chan];
+}
 
+//----------------------------------------------------------------------------
+// get_adc_full : read filtered a/d channel at full resolution
+// ============
+//
+// Description
+//      As get_adc but returns the 10-bit value (0->1023) when ADC_10BIT
+//      is set, otherwise the 8-bit value.
+//
+// Notes
+//      The interrupt routine only writes the other bank so the two bytes
+//      cannot change during the read.
+//
+uint16_t get_adc_full(a2d_channels_t chan) 
+{
+    return adc_value[adc_read_bank][chan];
+}
 
-    DISABLE_INTERRUPTS;
+//----------------------------------------------------------------------------
+// get_adc_fresh : read a/d channel converted after the call
+// =============
+//
+// Description
+//      Waits for a sample of the channel whose conversion started after
+//      entry to this routine. Channels with an EMA or median filter still
+//      include earlier scans in the result. If the channel is being converted, or has
+//      already been converted in the current scan, the following scan is
+//      needed. Can take up to two RTI ticks (16mS).
+//
+// Notes
+//      Must not be called with interrupts disabled.
+//
+uint8_t get_adc_fresh(a2d_channels_t chan) 
+{
+uint8_t   scan_channel, sequence, count;
 
-    ADC1SC1_ADCH = chan;
-    while(!ADC1SC1_COCO)
+    scan_channel = adc_scan_channel;        // read before sequence count
+    sequence = adc_sequence[chan];
+    count = 1;
+    if ((scan_channel != ADC_SCAN_IDLE) && (scan_channel >= chan)) {
+        count = 2;
+    }
+    while ((uint8_t)(adc_sequence[chan] - sequence) < count)
         ;
-    adc_value = ADC1RL;
-    
+    return adc_sample[adc_read_bank][chan];
+}
+
+//----------------------------------------------------------------------------
+// init_adc_scan : fill sample table by polling
+// =============
+//
+// Description
+//      Converts every channel once with the a/d interrupt disabled and
+//      copies the results to both banks so that get_adc returns valid
+//      readings before the first background scan.
+//
+// Notes
+//      Called from Init_adc before interrupts are enabled.
+//
+void init_adc_scan(void) 
+{
+uint8_t   chan, i;
+uint16_t  value;
+
+    for (chan=0 ; chan < NOS_ADC_CHANNELS ; chan++) {
+        value = 0;
+        for (i=0 ; i < ADC_OVERSAMPLE ; i++) {
+            ADC1SC1 = (AD_INT_DIS | AD_SING_CONV | chan);
+            while(!ADC1SC1_COCO)
+                ;
+            value += ADC1R;
+        }
+        value /= ADC_OVERSAMPLE;
+        adc_filter_state[chan][0] = value;
+        adc_filter_state[chan][1] = value;
+        if (adc_filter[chan] == ADC_FILTER_EMA) {
+            adc_filter_state[chan][0] = (value << 4);
+        }
+        adc_value[0][chan] = value;
+        adc_value[1][chan] = value;
+        adc_sample[0][chan] = (uint8_t)(value >> ADC_8BIT_SHIFT);
+        adc_sample[1][chan] = adc_sample[0][chan];
+        adc_sequence[chan] = 0;
+    }
+    ADC1SC1 = (AD_INT_DIS | AD_SING_CONV | AD_CHAN_DIS);
+    adc_read_bank = 0;
+    adc_scan_channel = ADC_SCAN_IDLE;
+    adc_oversample_count = 0;
+    adc_sum = 0;
+}
+
+//----------------------------------------------------------------------------
+// adc_start_scan : start a background scan of all channels
+// ==============
+//
+// Notes
+//      Run as an RTI task. A scan still in progress is left to finish.
+//
+void adc_start_scan(void) 
+{
+    if (adc_scan_channel != ADC_SCAN_IDLE) {
+        return;
+    }
+    ADC1SC2 = (AD_CONV_TRIG_SOFT | AD_COMP_FUNC_DIS | AD_COMP_GT_DIS);
+    adc_scan_channel = 0;
+    adc_oversample_count = 0;
+    adc_sum = 0;
+    ADC1SC1 = (AD_INT_EN | AD_SING_CONV | 0);
+}
+
+//----------------------------------------------------------------------------
+// adc_isr : handle a/d conversion complete interrupt
+// =======
+//
+// Description
+//      Accumulate the conversion. After ADC_OVERSAMPLE conversions filter
+//      the mean, store it in the write bank and start the next channel.
+//      At the end of the scan swap banks, update the sequence counts and
+//      turn the converter off.
+//
+// Notes
+//      Reading ADC1R clears the conversion complete flag.
+//
+void adc_isr(void) 
+{
+uint8_t    chan;
+uint16_t   value;
+
+    chan = adc_scan_channel;
+    if (chan == ADC_SCAN_IDLE) {            // hardware compare hit
+        (void)ADC1R;                        // clears conversion complete flag
+        ADC1SC2 = (AD_CONV_TRIG_SOFT | AD_COMP_FUNC_DIS | AD_COMP_GT_DIS);
+        ADC1SC1 = (AD_INT_DIS | AD_SING_CONV | AD_CHAN_DIS);
+        bump_watch_latch(bump_watch_next);
+        return;
+    }
+    adc_sum += ADC1R;
+    if (++adc_oversample_count < ADC_OVERSAMPLE) {
+        ADC1SC1 = (AD_INT_EN | AD_SING_CONV | chan);
+        return;
+    }
+    value = adc_sum / ADC_OVERSAMPLE;
+    if ((bump_watch_mask & ADC_CHANNEL_BIT(chan)) && (value < bump_watch_level)) {
+        bump_watch_latch(chan);
+    }
+    value = filter_sample(chan, value);
+    adc_value[adc_read_bank ^ 1][chan] = value;
+    adc_sample[adc_read_bank ^ 1][chan] = (uint8_t)(value >> ADC_8BIT_SHIFT);
+    adc_oversample_count = 0;
+    adc_sum = 0;
+    chan++;
+    if (chan < NOS_ADC_CHANNELS) {
+        adc_scan_channel = chan;
+        ADC1SC1 = (AD_INT_EN | AD_SING_CONV | chan);
+        return;
+    }
+    ADC1SC1 = (AD_INT_DIS | AD_SING_CONV | AD_CHAN_DIS);
+    adc_read_bank ^= 1;
+    for (chan=0 ; chan < NOS_ADC_CHANNELS ; chan++) {
+        adc_sequence[chan]++;
+    }
+    adc_scan_channel = ADC_SCAN_IDLE;
+    if (bump_watch_mask != 0) {
+        bump_watch_compare();
+    }
+}
+
+//----------------------------------------------------------------------------
+// bump_watch_latch : record a bump on a watched channel
+// ================
+//
+// Notes
+//      Called from the a/d interrupt. Only the first bump sets the
+//      channel and time.
+//
+static void bump_watch_latch(uint8_t chan) 
+{
+    if (bump_watch.events == 0) {
+        bump_watch.channel = chan;
+        bump_watch.time = tick_count_16;
+    }
+    bump_watch.events |= ADC_CHANNEL_BIT(chan);
+}
+
+//----------------------------------------------------------------------------
+// bump_watch_compare : set converter to watch the next channel between scans
+// ==================
+//
+// Notes
+//      Called from the a/d interrupt at the end of a scan. The continuous
+//      conversions are stopped by the next adc_start_scan.
+//
+static void bump_watch_compare(void) 
+{
+uint8_t   i;
+
+    for (i=0 ; i < NOS_ADC_CHANNELS ; i++) {
+        if (++bump_watch_next >= NOS_ADC_CHANNELS) {
+            bump_watch_next = 0;
+        }
+        if (bump_watch_mask & ADC_CHANNEL_BIT(bump_watch_next)) {
+            break;
+        }
+    }
+    ADC1CV = bump_watch_level;
+    ADC1SC2 = (AD_CONV_TRIG_SOFT | AD_COMP_FUNC_EN | AD_COMP_GT_DIS);     // interrupt if < ADC1CV
+    ADC1SC1 = (AD_INT_EN | AD_CONT_CONV | bump_watch_next);
+}
+
+//----------------------------------------------------------------------------
+// bump_watch_start : start watching a set of channels for a bump
+// ================
+//
+// Parameters
+//      channels  : ADC_CHANNEL_BIT() of each channel to watch
+//      threshold : 8-bit level; a reading below this is a bump
+//
+// Notes
+//      Clears any previous bump. The first check is made during the next
+//      background scan.
+//
+void bump_watch_start(uint16_t channels, uint8_t threshold) 
+{
+    DISABLE_INTERRUPTS;
+    bump_watch.events = 0;
+    bump_watch_level = ((uint16_t)threshold << ADC_8BIT_SHIFT);
+    bump_watch_mask = channels;
     ENABLE_INTERRUPTS;
-                   
-    return adc_value;
-    
+}
 
+//----------------------------------------------------------------------------
+// bump_watch_stop : stop watching for bumps
+// ===============
+//
+void bump_watch_stop(void) 
+{
+    DISABLE_INTERRUPTS;
+    bump_watch_mask = 0;
+    bump_watch.events = 0;
+    if (adc_scan_channel == ADC_SCAN_IDLE) {
+        ADC1SC2 = (AD_CONV_TRIG_SOFT | AD_COMP_FUNC_DIS | AD_COMP_GT_DIS);
+        ADC1SC1 = (AD_INT_DIS | AD_SING_CONV | AD_CHAN_DIS);
+    }
+    ENABLE_INTERRUPTS;
 }
 
 //----------------------------------------------------------------------------
-// interrupt_get_adc : read a/d converter from inside an interrupt routine
+// bump_watch_events : get set of channels that have bumped
 // =================
 //
-// Description
-//      The normal 'get_adc' routine disables/enables the interrupt system
-//      when it operates.  This is necessary since I want to do some a/d
-//      conversions within an interrupt routine.  
-//      
-uint8_t interrupt_get_adc(a2d_channels_t chan) 
+// Returns
+//      ADC_CHANNEL_BIT() of each channel that has read below the threshold
+//      since bump_watch_start or bump_watch_clear. 0 = no bump.
+//
+uint16_t bump_watch_events(void) 
+{
+uint16_t  events;
+
+    DISABLE_INTERRUPTS;
+    events = bump_watch.events;
+    ENABLE_INTERRUPTS;
+    return events;
+}
+
+//----------------------------------------------------------------------------
+// bump_watch_clear : clear latched bumps and carry on watching
+// ================
+//
+// Notes
+//      A sensor that is still below the threshold is latched again by the
+//      next scan.
+//
+void bump_watch_clear(void) 
 {
-    ADC1SC1_ADCH = chan;
-    while(!ADC1SC1_COCO)
-        ;                   
-    return ADC1RL;
-}
\ No newline at end of file
+    DISABLE_INTERRUPTS;
+    bump_watch.events = 0;
+    ENABLE_INTERRUPTS;
+}
@@ -65,6 +65,7 @@ uint8_t       activity;
 // 
         show_dual_chars('b', ('0'+ activity), 0);
         push_LED_display();        
+        runlog_start(RUNLOG_ID(BUMP_MODE, activity));
         switch (activity) {
             case LINE_BUMP_MODE :    
                 run_line_bump_mode();
@@ -78,6 +79,7 @@ uint8_t       activity;
             default :
                 break;                    
         }
+        runlog_stop();
         pop_LED_display();
         show_dual_chars('b', ('0'+ activity), (A_TO_FLASH | 10));
         B_MODE_LEDS;           
@@ -102,7 +104,8 @@ uint8_t       activity;
 //
 uint8_t run_wall_bump_mode(void) {
 
-uint8_t       ad_value, bump_L, bump_C, bump_R, bump, time_reverse, time_spin; 
+uint8_t       ad_value, bump, time_reverse, time_spin; 
+uint16_t      bumps;
 mode_state_t  state;
 int8_t        speed_differential;
 uint16_t      time; 
@@ -129,6 +132,7 @@ uint16_t      time;
             if (time > LINE_BUMP_TIME_OUT ) {
                 state = MODE_INIT;
                 vehicle_stop();
+                bump_watch_stop();
                 continue;
                 }
         }
@@ -162,6 +166,7 @@ uint16_t      time;
 //
         if (switch_C == PRESSED) {            //  exit mode
             vehicle_stop();
+            bump_watch_stop();
             SOUND_EXIT_SELECTION;
             WAIT_SWITCH_RELEASED(switch_C);
             return 0;
@@ -175,6 +180,7 @@ uint16_t      time;
                 state = MODE_RUNNING;
                 CLR_TIMER16;                      // reset timeout timer
                 WAIT_SWITCH_RELEASED(switch_A); 
+                bump_watch_start(FRONT_SENSORS, (YES_BUMP + DEADBAND));
             } else {
                 continue;                         // back to begining of FOREVER loop
             }
@@ -183,32 +189,34 @@ uint16_t      time;
             if (switch_A == PRESSED) {            // halt bump activity
                 state = MODE_INIT;
                 vehicle_stop();
+                bump_watch_stop();
                 WAIT_SWITCH_RELEASED(switch_A);
                 continue;
             }
         } 
 //
-// read bump sensors
+// collect bumps latched by the a/d background scan
 //
-        bump_L = get_adc(FRONT_SENSOR_L);           
-        bump_C = get_adc(FRONT_SENSOR_C);           
-        bump_R = get_adc(FRONT_SENSOR_R);   
+        bumps = bump_watch_events();
+        if (bumps != 0) {
+            runlog_event(RUNLOG_BUMP, (uint8_t)(bumps >> FRONT_SENSOR_L));
+        }
 //
 // process bump sensor readings into digital values and combine into a single 
 // 3-bit line value
 //
         bump = 0b111;
-        if (bump_L < (YES_BUMP + DEADBAND)){
+        if (bumps & ADC_CHANNEL_BIT(FRONT_SENSOR_L)){
             bump &= 0b011;
             vehicle_stop();
             beep(NOTE_C, 1);
         }
-        if (bump_C < (YES_BUMP + DEADBAND)){
+        if (bumps & ADC_CHANNEL_BIT(FRONT_SENSOR_C)){
             bump &= 0b101;
             vehicle_stop();
             beep(NOTE_C, 2);
         }
-        if (bump_R < (YES_BUMP + DEADBAND)){
+        if (bumps & ADC_CHANNEL_BIT(FRONT_SENSOR_R)){
             bump &= 0b110;
             vehicle_stop();
             beep(NOTE_C, 3);
@@ -220,87 +228,74 @@ uint16_t      time;
             case LCR : //  000 - L = yes , C = yes , R = yes => reverse + random spin
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);
                 if (get_random_bit() == 0) {   // spin in a random direction                  
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                    set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 }else {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 }
                 DelayMs(time_spin * 100);                
                 break;
             case LCx : //  001 - L = yes , C = yes , R =  no => reverse + spin right
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_spin * 100);                
                 break;
             case LxR : //  010 - L = yes , C =  no , R = yes => reverse + random spin
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);
                 if (get_random_bit() == 0) {   // spin in a random direction                  
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                    set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 }else {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 }
                 DelayMs(time_spin * 100);              
                 break;
             case Lxx : //  011 - L = yes , C =  no , R =  no => spin right
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_OFF, 0);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_OFF, 0, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_spin * 100);                
                 break;
             case xCR : //  100 - L =  no , C = yes , R = yes => reverse + spin left
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 DelayMs(time_spin * 100);                
                 break;
             case xCx : //  101 - L =  no , C = yes , R =  no => reverse + spin
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);
                 if (get_random_bit() == 0) {   // spin in a random direction                  
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                    set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 }else {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 }
                 DelayMs(time_spin * 100);              
                 break;
             case xxR : //  110 - L =  no , C =  no , R = yes => reverse + spin
                 vehicle_stop();
                 SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_OFF, 0);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_OFF, 0);
                 DelayMs(time_spin * 100);                
                 break;
             case xxx : //  111 - L =  no , C =  no , R =  no => forward action
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);               
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 break;
         }
+        if (bumps != 0) {
+            bump_watch_clear();         // ignore bumps latched during the manoeuvre
+        }
     }
 }
 
@@ -439,41 +434,33 @@ mode_state_t  state;
             case 0 : //  00 - line detected by both sensors :: reverse + random spin
                 vehicle_stop();
 //                SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);
                 if (get_random_bit() == 0) {   // spin in a random direction                  
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                    set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 }else {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 }
                 DelayMs(time_spin * 100);     
                 break;
             case 1 : //  01 - line detected by left sensor therefore turn right
                 vehicle_stop();
 //                SOUND_TAPE_BUMP;
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 50);
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed); 
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_spin * 100);          
                 break;
             case 2 : //  10 - line detected by right sensor therfore turn left
                 vehicle_stop();
 //                SOUND_TAPE_BUMP; 
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_reverse * 100);                
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed); 
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 DelayMs(time_spin * 100);           
                 break;
             case 3 : //  11 - no line detected therfore drive straight forward
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);           
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 break;
         } 
     }
@@ -620,8 +607,7 @@ mode_state_t  state;
                 time_stop = (get_random_byte() & 0x0F);  // between 0 and 15 time units
                 DelayMs(time_stop * 100);
                 
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 
                 time_reverse = (get_random_byte() & 0x07) + 3;  // between 3 and 11 time units
                 DelayMs(time_reverse * 100);
@@ -631,11 +617,9 @@ mode_state_t  state;
                 DelayMs(time_stop * 100);
                                 
                 if (get_random_bit() == 0) {   // spin in a random direction                  
-                    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                    set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 }else {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 }
                 time_spin = (get_random_byte() & 0x07) + 1;  // between 1 and 8 time units
                 DelayMs(time_spin * 100);
@@ -662,8 +646,7 @@ mode_state_t  state;
                 break;
                 
             case 3 : //  11 - no line detected therfore drive straight forward
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);           
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 break;
         } 
     }
@@ -0,0 +1,527 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// compiler.c : compile a subset of uBASIC into a robot command sequence
+// ==========
+//
+// Description
+//      Translates the straight-line and loop subset of uBASIC into the
+//      16-bit instructions run by the stack machine in interpreter.c. The
+//      compiled program runs much faster than the text based interpreter
+//      and can be saved to FLASH with save_sequence().
+//
+//      Supported statements
+//          let, for/next, if..then, goto, end, speed, motors, wait, sense
+//
+//      Restrictions
+//          1. variables 'a' to 'l' only (the remaining stack machine
+//             variables hold the for loop limits)
+//          2. expressions use + - & | only
+//          3. 'motors' and 'wait' take numbers, not expressions
+//          4. 'sense' of the switch channels (16-19) is not supported
+//          5. comparisons are unsigned
+//          6. numbers and line numbers are 0 to 255
+//
+//      Any other statement is reported on the serial port with its line
+//      number and compilation stops.
+//
+// Notes
+//      The tokenizer from ubasic.c is reused. The source text must not be
+//      in the shared RAM area as the sequence is built there.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+#define   NOS_BASIC_VARIABLES   (NOS_VARIABLES - MAX_COMPILE_FORS)      // a -> l
+
+static jmp_buf   compile_env;
+static uint16_t  compile_pc;        // next free sequence location
+static uint8_t   compile_line;      // current BASIC line number
+static uint8_t   compile_depth;     // stack machine stack depth
+static uint8_t   line_count, fixup_count, for_count;
+
+static void statement(void);
+
+//----------------------------------------------------------------------------
+// compile_error : report a compile error and abandon compilation
+// =============
+//
+static void compile_error(const char *message) 
+{
+    send_msg("Compile error line ");
+    send_msg(bcd(compile_line, tempstring));
+    send_msg(" : ");
+    send_msg((char *)message);
+    send_msg("\r\n");
+    longjmp(compile_env, 1);
+}
+
+//----------------------------------------------------------------------------
+// emit : add an instruction to the sequence
+// ====
+//
+static void emit(uint8_t inst, uint8_t modifier, uint8_t data) 
+{
+    if (compile_pc >= RAM_SEQUENCE_SIZE) {
+        compile_error("program too large");
+    }
+    store_instruction(shared.RAM_sequence.uint16, (uint8_t)compile_pc, inst, modifier, data);
+    compile_pc++;
+}
+
+//----------------------------------------------------------------------------
+// push_count : track stack machine stack usage
+// ==========
+//
+static void push_count(void) 
+{
+    compile_depth++;
+    if (compile_depth > STACK_SIZE) {
+        compile_error("expression too complex");
+    }
+}
+
+//----------------------------------------------------------------------------
+// token handling
+//
+static void expect(uint8_t token) 
+{
+    if (tokenizer_token() != token) {
+        compile_error("syntax error");
+    }
+    tokenizer_next();
+}
+
+static void end_of_line(void) 
+{
+    if (tokenizer_token() == TOKENIZER_ELSE) {
+        compile_error("else not supported");
+    }
+    if (tokenizer_token() == TOKENIZER_ENDOFINPUT) {
+        return;
+    }
+    expect(TOKENIZER_CR);
+}
+
+static uint8_t variable(void) 
+{
+uint8_t  var;
+
+    if (tokenizer_token() != TOKENIZER_VARIABLE) {
+        compile_error("variable expected");
+    }
+    var = tokenizer_variable_num();
+    if (var >= NOS_BASIC_VARIABLES) {
+        compile_error("only variables a to l allowed");
+    }
+    tokenizer_next();
+    return var;
+}
+
+static uint8_t number(void) 
+{
+int16_t  value;
+
+    if (tokenizer_token() != TOKENIZER_NUMBER) {
+        compile_error("number expected");
+    }
+    value = tokenizer_num();
+    if ((value < 0) || (value > 255)) {         // also the line number range
+        compile_error("number out of range");
+    }
+    tokenizer_next();
+    return (uint8_t)value;
+}
+
+//----------------------------------------------------------------------------
+// expression compilation : each leaves one value on the stack machine stack
+//
+static void expr(void);
+
+static void factor(void) 
+{
+    switch (tokenizer_token()) {
+        case TOKENIZER_NUMBER :
+            emit(PUSH_L8, IMMEDIATE, number());
+            push_count();
+            break;
+        case TOKENIZER_VARIABLE :
+            emit(PUSH_16, REGISTER, variable());
+            push_count();
+            break;
+        case TOKENIZER_LEFTPAREN :
+            tokenizer_next();
+            expr();
+            expect(TOKENIZER_RIGHTPAREN);
+            break;
+        default :
+            compile_error("bad expression");
+            break;
+    }
+}
+
+static void term(void) 
+{
+uint8_t  op;
+
+    factor();
+    op = tokenizer_token();
+    if ((op == TOKENIZER_ASTR) || (op == TOKENIZER_SLASH) || (op == TOKENIZER_MOD)) {
+        compile_error("* / % not supported");
+    }
+}
+
+static void expr(void) 
+{
+uint8_t  op;
+
+    term();
+    op = tokenizer_token();
+    while ((op == TOKENIZER_PLUS) || (op == TOKENIZER_MINUS) || 
+           (op == TOKENIZER_AND) || (op == TOKENIZER_OR)) {
+        tokenizer_next();
+        term();
+        switch (op) {
+            case TOKENIZER_PLUS  : emit(COMPUTE, NO_MOD, ADD); break;
+            case TOKENIZER_MINUS : emit(COMPUTE, NO_MOD, SUB); break;
+            case TOKENIZER_AND   : emit(COMPUTE, NO_MOD, AND); break;
+            case TOKENIZER_OR    : emit(COMPUTE, NO_MOD, OR);  break;
+        }
+        compile_depth--;
+        op = tokenizer_token();
+    }
+}
+
+//----------------------------------------------------------------------------
+// find_line : get sequence address of a BASIC line
+// =========
+//
+// Returns
+//      address, or 0xFFFF if line has not been compiled
+//
+static uint16_t find_line(uint8_t line) 
+{
+uint8_t  i;
+
+    for (i=0 ; i < line_count ; i++) {
+        if (shared.compile.line_table[i][0] == line) {
+            return shared.compile.line_table[i][1];
+        }
+    }
+    return 0xFFFF;
+}
+
+//----------------------------------------------------------------------------
+// statement compilation
+//
+static void let_statement(void) 
+{
+uint8_t  var;
+
+    var = variable();
+    expect(TOKENIZER_EQ);
+    expr();
+    emit(POP_16, NO_MOD, var);
+    compile_depth = 0;
+    end_of_line();
+}
+
+static void for_statement(void) 
+{
+uint8_t  var, limit;
+
+    expect(TOKENIZER_FOR);
+    if (for_count >= MAX_COMPILE_FORS) {
+        compile_error("for loops nested too deep");
+    }
+    var = variable();
+    expect(TOKENIZER_EQ);
+    expr();
+    emit(POP_16, NO_MOD, var);
+    compile_depth = 0;
+    expect(TOKENIZER_TO);
+    limit = NOS_BASIC_VARIABLES + for_count;
+    expr();
+    emit(POP_16, NO_MOD, limit);
+    compile_depth = 0;
+    end_of_line();
+    shared.compile.for_stack[for_count][0] = var;
+    shared.compile.for_stack[for_count][1] = (uint8_t)compile_pc;
+    for_count++;
+}
+
+static void next_statement(void) 
+{
+uint8_t  var, limit;
+
+    expect(TOKENIZER_NEXT);
+    var = variable();
+    if ((for_count == 0) || (shared.compile.for_stack[for_count - 1][0] != var)) {
+        compile_error("next without matching for");
+    }
+    for_count--;
+    limit = NOS_BASIC_VARIABLES + for_count;
+    emit(PUSH_16, REGISTER, var);               // var = var + 1
+    emit(PUSH_L8, IMMEDIATE, 1);
+    emit(COMPUTE, NO_MOD, ADD);
+    emit(POP_16, NO_MOD, var);
+    emit(PUSH_16, REGISTER, limit);             // exit loop if var > limit
+    emit(PUSH_16, REGISTER, var);
+    emit(TEST_AND_SKIP, NO_MOD, GT);
+    emit(GOTO, ABSOLUTE, shared.compile.for_stack[for_count][1]);
+    end_of_line();
+}
+
+static void if_statement(void) 
+{
+uint8_t   op, test;
+uint16_t  skip_pc;
+
+    test = EQ;
+
+    expect(TOKENIZER_IF);
+    expr();
+    op = tokenizer_token();
+    switch (op) {
+        case TOKENIZER_LT : test = GT; break;     // TEST_AND_SKIP compares top with next
+        case TOKENIZER_GT : test = LT; break;
+        case TOKENIZER_EQ : test = EQ; break;
+        default :
+            compile_error("if needs <, > or =");
+            break;
+    }
+    tokenizer_next();
+    expr();
+    emit(TEST_AND_SKIP, NO_MOD, test);
+    compile_depth = 0;
+    skip_pc = compile_pc;
+    emit(GOTO, ABSOLUTE, 0);                    // patched below
+    expect(TOKENIZER_THEN);
+    if ((tokenizer_token() == TOKENIZER_FOR) || (tokenizer_token() == TOKENIZER_NEXT)) {
+        compile_error("for/next not allowed after then");
+    }
+    statement();
+    store_instruction(shared.RAM_sequence.uint16, (uint8_t)skip_pc, GOTO, ABSOLUTE, (uint8_t)compile_pc);
+}
+
+static void goto_statement(void) 
+{
+uint8_t   line;
+uint16_t  address;
+
+    expect(TOKENIZER_GOTO);
+    line = number();
+    address = find_line(line);
+    if (address == 0xFFFF) {                    // forward reference
+        if (fixup_count >= MAX_COMPILE_FIXUPS) {
+            compile_error("too many forward gotos");
+        }
+        shared.compile.fixups[fixup_count][0] = (uint8_t)compile_pc;
+        shared.compile.fixups[fixup_count][1] = line;
+        fixup_count++;
+        address = 0;
+    }
+    emit(GOTO, ABSOLUTE, (uint8_t)address);
+    end_of_line();
+}
+
+static void end_statement(void) 
+{
+    expect(TOKENIZER_END);
+    emit(EXECUTE, NO_MOD, STOP);
+    emit(EXIT, NO_MOD, NO_DATA);
+    end_of_line();
+}
+
+static void speed_statement(void) 
+{
+    expect(TOKENIZER_SPEED);
+    expr();
+    emit(PUSH_L8, IMMEDIATE, MOTOR_FORWARD);
+    emit(PUSH_L8, IMMEDIATE, LEFT_MOTOR);
+    push_count(); push_count();
+    emit(SET_PARAMETER, NO_MOD, SPEED);
+    compile_depth = 0;
+    expr();
+    emit(PUSH_L8, IMMEDIATE, MOTOR_FORWARD);
+    emit(PUSH_L8, IMMEDIATE, RIGHT_MOTOR);
+    push_count(); push_count();
+    emit(SET_PARAMETER, NO_MOD, SPEED);
+    compile_depth = 0;
+    end_of_line();
+}
+
+//
+// BASIC motor codes 0=stop, 1=forward, 2=backward
+//
+static uint8_t motor_code(void) 
+{
+    switch (number()) {
+        case 0  : return MOTOR_BRAKE;
+        case 1  : return MOTOR_FORWARD;
+        case 2  : return MOTOR_BACKWARD;
+        default :
+            compile_error("motors values are 0, 1 or 2");
+            break;
+    }
+    return MOTOR_BRAKE;
+}
+
+static void motors_statement(void) 
+{
+uint8_t  left, right;
+
+    expect(TOKENIZER_MOTORS);
+    left = motor_code();
+    right = motor_code();
+    emit(DRIVE, NO_MOD, DRIVE_STATES(left, right));
+    end_of_line();
+}
+
+static void wait_statement(void) 
+{
+    expect(TOKENIZER_WAIT);
+    emit(DELAY, IMMEDIATE, number());           // both in units of 0.1 sec
+    end_of_line();
+}
+
+static void sense_statement(void) 
+{
+uint8_t  channel;
+
+    expect(TOKENIZER_SENSE);
+    channel = number();
+    if (channel >= DUMMY_LAST_SENSOR) {
+        compile_error("sense of switches not supported");
+    }
+    emit(READ_CHAN, IMMEDIATE, channel);
+    emit(POP_16, NO_MOD, variable());
+    end_of_line();
+}
+
+static void statement(void) 
+{
+    switch (tokenizer_token()) {
+        case TOKENIZER_LET :
+            tokenizer_next();
+            let_statement();
+            break;
+        case TOKENIZER_VARIABLE :
+            let_statement();
+            break;
+        case TOKENIZER_FOR :
+            for_statement();
+            break;
+        case TOKENIZER_NEXT :
+            next_statement();
+            break;
+        case TOKENIZER_IF :
+            if_statement();
+            break;
+        case TOKENIZER_GOTO :
+            goto_statement();
+            break;
+        case TOKENIZER_END :
+            end_statement();
+            break;
+        case TOKENIZER_SPEED :
+            speed_statement();
+            break;
+        case TOKENIZER_MOTORS :
+            motors_statement();
+            break;
+        case TOKENIZER_WAIT :
+            wait_statement();
+            break;
+        case TOKENIZER_SENSE :
+            sense_statement();
+            break;
+        case TOKENIZER_PRINT :  compile_error("print not compilable");  break;
+        case TOKENIZER_GOSUB :
+        case TOKENIZER_RETURN : compile_error("gosub/return not compilable");  break;
+        case TOKENIZER_LEDS :   compile_error("leds not compilable");   break;
+        case TOKENIZER_READ :   compile_error("read not compilable");   break;
+        case TOKENIZER_TEXT :   compile_error("text not compilable");   break;
+        case TOKENIZER_TONE :   compile_error("tone not compilable");   break;
+        default :
+            compile_error("unknown statement");
+            break;
+    }
+}
+
+//----------------------------------------------------------------------------
+// compile_basic : compile a uBASIC program into the RAM sequence area
+// =============
+//
+// Parameters
+//      program : uBASIC source text (normally a ROM script)
+//
+// Returns
+//      number of instructions generated, or 0 on error (reported on the
+//      serial port)
+//
+// Notes
+//      Unused locations are set to 0xFFFF (erased FLASH state) so the
+//      result can go straight to save_sequence().
+//
+uint16_t compile_basic(const char *program) 
+{
+uint8_t   i;
+uint16_t  address;
+
+    compile_line = 0;
+    if (((char *)program >= (char *)&shared) && ((char *)program < ((char *)&shared + sizeof(shared)))) {
+        send_msg("Compile error : source in sequence area\r\n");
+        return 0;
+    }
+    compile_pc = 0;
+    compile_depth = 0;
+    line_count = 0;
+    fixup_count = 0;
+    for_count = 0;
+    if (setjmp(compile_env) != 0) {
+        return 0;                                  // error already reported
+    }
+    tokenizer_init(program);
+//
+// compile line by line
+//
+    while (!tokenizer_finished()) {
+        if (tokenizer_token() == TOKENIZER_CR) {      // blank line
+            tokenizer_next();
+            continue;
+        }
+        compile_line = number();
+        if (line_count >= MAX_COMPILE_LINES) {
+            compile_error("too many lines");
+        }
+        shared.compile.line_table[line_count][0] = compile_line;
+        shared.compile.line_table[line_count][1] = (uint8_t)compile_pc;
+        line_count++;
+        statement();
+    }
+    if (for_count != 0) {
+        compile_error("for without next");
+    }
+    emit(EXECUTE, NO_MOD, STOP);                   // implied end
+    emit(EXIT, NO_MOD, NO_DATA);
+//
+// resolve forward gotos
+//
+    for (i=0 ; i < fixup_count ; i++) {
+        address = find_line(shared.compile.fixups[i][1]);
+        if (address == 0xFFFF) {
+            compile_line = shared.compile.fixups[i][1];
+            compile_error("goto to missing line");
+        }
+        store_instruction(shared.RAM_sequence.uint16, shared.compile.fixups[i][0], GOTO, ABSOLUTE, (uint8_t)address);
+    }
+    for (address = compile_pc ; address < RAM_SEQUENCE_SIZE ; address++) {
+        shared.RAM_sequence.uint16[address] = 0xFFFF;
+    }
+    return compile_pc;
+}
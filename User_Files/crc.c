@@ -0,0 +1,43 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// crc.c : CRC-16/CCITT (polynomial 0x1021) calculation
+// =====
+//
+// Description
+//      Table driven four bits at a time so the table is only 16 entries.
+//      Start with CRC16_INIT; CRC of "123456789" is 0x29B1.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+const uint16_t crc16_table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+//----------------------------------------------------------------------------
+// crc16_update : add a block of bytes to a CRC
+// ============
+//
+// Parameters
+//      crc    : CRC so far (CRC16_INIT for a new calculation)
+//      data   : bytes to add
+//      length : number of bytes
+//
+// Returns
+//      updated CRC
+//
+uint16_t crc16_update(uint16_t crc, const uint8_t *data, uint16_t length) {
+
+    while (length-- != 0) {
+        crc = (crc << 4) ^ crc16_table[(uint8_t)(crc >> 12) ^ (*data >> 4)];
+        crc = (crc << 4) ^ crc16_table[(uint8_t)(crc >> 12) ^ (*data & 0x0F)];
+        data++;
+    }
+    return crc;
+}
@@ -59,6 +59,8 @@ void delay_1ms(void) {
 //
 // Notes
 //      Function uses the supplied 'Delay100US' routine
+//      The run logger uses the delay as idle time to write to flash,
+//      which can lengthen the delay by up to 1.5mS per row written.
 //
 void DelayMs(uint16_t count) {
 	uint16_t i;
@@ -68,6 +70,7 @@ void DelayMs(uint16_t count) {
 	}
 	for (i = 0; i < count; i++) {
 		delay_1ms(); //delay 1 millisecond
+		runlog_idle();
 	}
 	return;
 }
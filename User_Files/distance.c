@@ -232,12 +232,14 @@ mode_state_t    state;
 //
     CLEAR_AD_WHEEL_COUNTERS;
 //
-    set_motor(LEFT_MOTOR, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
-    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
+    set_motors(MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
     DelayMs(2000);
     vehicle_stop();
-    sprintf(tempstring, "Left=%u   Right=%u\r\n", left_wheel_count, right_wheel_count);
-    send_msg(tempstring);    
+    send_msg("Left=");
+    send_u16(left_wheel_count);
+    send_msg("   Right=");
+    send_u16(right_wheel_count);
+    send_msg("\r\n");
     
     return 0;
     }
@@ -331,8 +333,7 @@ uint8_t     max_left_value, min_left_value, max_right_value, min_right_value;
       // Calibration procedure
       //   1. Run robot at a slow speed
       //   
-        set_motor(LEFT_MOTOR, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
-        set_motor(RIGHT_MOTOR, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
+        set_motors(MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
       //
       // 2. Read wheel sensor as a set of analogue values (range 0->255)
       //
@@ -369,21 +370,25 @@ uint8_t     max_left_value, min_left_value, max_right_value, min_right_value;
       //
       //   4. store in FLASH area for later use   (Time for FLASH write to work?)
       //
-        memcpy(&FLASH_data, &FLASH_data_image, sizeof(FLASH_data_t));
-        FLASH_data_image.LEFT_WHEEL_THRESHOLD = left_threshold;
-        FLASH_data_image.RIGHT_WHEEL_THRESHOLD = right_threshold;
-        FlashErasePage((uint16_t)&FLASH_data.GUARD_BYTE);
-        FlashProgramByte((uint16_t)&FLASH_data.LEFT_WHEEL_THRESHOLD, FLASH_data_image.LEFT_WHEEL_THRESHOLD);
-        FlashProgramByte((uint16_t)&FLASH_data.RIGHT_WHEEL_THRESHOLD, FLASH_data_image.RIGHT_WHEEL_THRESHOLD);
+        if (save_wheel_thresholds(left_threshold, right_threshold) != KV_OK) {
+            send_msg("FLASH write failed\r\n");
+        }
       //
       //   5. Print values on serial channel
       //                                                                                
-       sprintf(tempstring, "Left=%u   Right=%u\r\n", left_threshold, right_threshold);
-       send_msg(tempstring);
-       sprintf(tempstring, "Left:min=%u  max=%u\r\n", min_left_value, max_left_value);
-       send_msg(tempstring);
-       sprintf(tempstring, "Right:min=%u  max=%u\r\n", min_right_value, max_right_value);
-       send_msg(tempstring);
+       send_msg("Left=");
+       send_u16(left_threshold);
+       send_msg("   Right=");
+       send_u16(right_threshold);
+       send_msg("\r\nLeft:min=");
+       send_u16(min_left_value);
+       send_msg("  max=");
+       send_u16(max_left_value);
+       send_msg("\r\nRight:min=");
+       send_u16(min_right_value);
+       send_msg("  max=");
+       send_u16(max_right_value);
+       send_msg("\r\n");
        return 0;
     }
 }
@@ -402,8 +407,7 @@ void calibrate(void) {
 	uint8_t left_value, right_value, left_threshold, right_threshold;
 	uint8_t max_left_value, min_left_value, max_right_value, min_right_value;
 
-	set_motor(LEFT_MOTOR, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
-	set_motor(RIGHT_MOTOR, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
+	set_motors(MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED, MOTOR_FORWARD, WHEEL_SENSOR_CALIBRATE_SPEED);
 	//
 	// 2. Read wheel sensor as a set of analogue values (range 0->255)
 	//
@@ -440,16 +444,79 @@ void calibrate(void) {
 	//
 	//   4. store in FLASH area for later use   (Time for FLASH write to work?)
 	//
-	memcpy(&FLASH_data, &FLASH_data_image, sizeof(FLASH_data_t));
-	FLASH_data_image.LEFT_WHEEL_THRESHOLD = left_threshold;
-	FLASH_data_image.RIGHT_WHEEL_THRESHOLD = right_threshold;
-	FlashErasePage((uint16_t) &FLASH_data.GUARD_BYTE);
-	FlashProgramByte((uint16_t) &FLASH_data.LEFT_WHEEL_THRESHOLD,
-			FLASH_data_image.LEFT_WHEEL_THRESHOLD);
-	FlashProgramByte((uint16_t) &FLASH_data.RIGHT_WHEEL_THRESHOLD,
-			FLASH_data_image.RIGHT_WHEEL_THRESHOLD);
+	if (save_wheel_thresholds(left_threshold, right_threshold) != KV_OK) {
+		send_msg("FLASH write failed\r\n");
+	}
+
+}
+//----------------------------------------------------------------------------
+// load_wheel_thresholds : get wheel sensor thresholds from the key/value store
+// =====================
+//
+// Returns
+//      PERSIST_OK, PERSIST_LEGACY or PERSIST_DEFAULT
+//
+// Notes
+//      Call after kv_init. A robot calibrated before the store existed
+//      has its thresholds in FLASH_data, which are used until the next
+//      calibration. The old firmware never programmed the guard byte,
+//      so a guard byte that is not erased means the page is not valid
+//      threshold data. A threshold of 0x00 or 0xFF (e.g. after an
+//      interrupted erase) would stop the wheel counts. In both cases
+//      the thresholds are replaced by WHEEL_THRESHOLD_DEFAULT.
+//
+uint8_t load_wheel_thresholds(void)
+{
+uint16_t  left, right;
+uint8_t   state;
+
+    state = PERSIST_OK;
+    if ((kv_read(KV_LEFT_WHEEL_THRESHOLD, &left) != KV_OK) || 
+        (kv_read(KV_RIGHT_WHEEL_THRESHOLD, &right) != KV_OK)) {
+        left = FLASH_data.LEFT_WHEEL_THRESHOLD;
+        right = FLASH_data.RIGHT_WHEEL_THRESHOLD;
+        state = PERSIST_LEGACY;
+        if (FLASH_data.GUARD_BYTE != 0xFF) {
+            left = 0x00;                        // force defaults
+        }
+    }
+    if ((left == 0x00) || (left >= 0xFF) || (right == 0x00) || (right >= 0xFF)) {
+        left = WHEEL_THRESHOLD_DEFAULT;
+        right = WHEEL_THRESHOLD_DEFAULT;
+        state = PERSIST_DEFAULT;
+    }
+    left_wheel_threshold = (uint8_t)left;
+    right_wheel_threshold = (uint8_t)right;
+    return state;
+}
+
+//----------------------------------------------------------------------------
+// save_wheel_thresholds : store wheel sensor thresholds
+// =====================
+//
+// Parameters
+//      left_threshold, right_threshold : black/white thresholds (0->255)
+//
+// Returns
+//      KV_OK or a FLASH_ERR_xxx code
+//
+// Notes
+//      New thresholds are used at once. Normally two record writes; the
+//      occasional compaction masks interrupts for about 20mS.
+//
+uint8_t save_wheel_thresholds(uint8_t left_threshold, uint8_t right_threshold)
+{
+uint8_t   status;
 
+    left_wheel_threshold = left_threshold;
+    right_wheel_threshold = right_threshold;
+    status = kv_write(KV_LEFT_WHEEL_THRESHOLD, left_threshold);
+    if (status != KV_OK) {
+        return status;
+    }
+    return kv_write(KV_RIGHT_WHEEL_THRESHOLD, right_threshold);
 }
+
 //----------------------------------------------------------------------------
 // move_distance : run robot for a set number of wheel encoder counts
 // =============
@@ -461,55 +528,25 @@ void calibrate(void) {
 //      r_speed        : speed of right motor (0 -> 100%)
 //
 // Description
-//      Crude distance move routine.  Stops after specified count.
-//      No speed profile at this time.
+//      Runs a profiled move (motion.c) and waits for it to finish. For
+//      code that needs the robot stopped after each move (e.g. sensor
+//      calibration). Sequences queue their moves directly so that they
+//      can run on without stopping.
 //      
-// Notes
-//
+// Returns
+//      0 if the count was reached, 1 if the wheels stalled
 //
 uint8_t move_distance(uint16_t encoder_counts, motor_t unit, int8_t l_speed, int8_t r_speed) 
 {
-   //
-   // clear encoder wheel counter
-   //
     CLEAR_AD_WHEEL_COUNTERS;
-//
-// set left motor; check if forward or backward move required
-//    
-    if (l_speed < 0) {
-        set_motor(LEFT_MOTOR, MOTOR_BACKWARD, (uint8_t)(-l_speed));
-    } else {
-        set_motor(LEFT_MOTOR, MOTOR_FORWARD, (uint8_t)l_speed); 
+    while (move_queue_distance(encoder_counts, unit, l_speed, r_speed) == 0) {
+        ;
     }
-//
-// set right motor; check if forward or backward move required
-// 
-    if (r_speed < 0) {
-        set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, (uint8_t)(-r_speed));
-    } else {
-        set_motor(RIGHT_MOTOR, MOTOR_FORWARD, (uint8_t)r_speed); 
+    while (move_done() == 0) {
+        ;
     }
-//
-// check if left wheel count has reached, or exceeded specifies encoder count
-//
-    if (unit == LEFT_MOTOR) {
-        while (left_wheel_count < encoder_counts) {   
-            ;
-        }
-        vehicle_stop();
-        return 0;
-    }
-//
-// check if right wheel count has reached, or exceeded specifies encoder count
-//    
-    if (unit == RIGHT_MOTOR) {
-        while (right_wheel_count < encoder_counts) {
-            ;
-        }
-        vehicle_stop();
-        return 0;        
+    if (move_phase() == MOVE_STALLED) {
+        return 1;
     }
-    
+    return 0;
 }
-
-
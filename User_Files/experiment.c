@@ -37,6 +37,8 @@ extern volatile  uint8_t    flash_test;
 //          8.  serial port echo test ('e' to exit)
 //          9.  Read switches
 //          10. Test ubasic scripting facility
+//          11. Compile ubasic script to a robot sequence
+//          12. ISR execution time and CPU load report
 //
 //      Active switches are 
 //          switch A = go/stop button
@@ -115,6 +117,12 @@ uint8_t       experiment;
             case 10 :       // Experiment 10 : run an example ubasic script
                 experiment_10();
                 break;       
+            case 11 :       // Experiment 11 : compile a ubasic script to a sequence
+                experiment_11();
+                break;       
+            case 12 :       // Experiment 12 : ISR execution time and CPU load report
+                experiment_12();
+                break;       
              default :
                 break;
         }
@@ -210,28 +218,24 @@ uint8_t   i, j, ad_value;
 
     for(i=0 ; i<count ; i++){
         for(j=0 ; j<100 ; j++) {
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, 75);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, 75);
+            set_motors(MOTOR_FORWARD, 75, MOTOR_FORWARD, 75);
             DelayMs(30000);
             ad_value = get_adc(BATTERY_VOLTS);   
             send_msg(bcd(ad_value, tempstring));
             send_msg(",");
             DelayMs(20000);                                                    
-            set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-            set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
+            set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
             DelayMs(10000);
             ad_value = get_adc(BATTERY_VOLTS);                    
             send_msg(bcd(ad_value, tempstring));
             send_msg(",\r\n");                                           
-            set_motor(LEFT_MOTOR, MOTOR_BACKWARD, 50);
-            set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, 50);
+            set_motors(MOTOR_BACKWARD, 50, MOTOR_BACKWARD, 50);
             DelayMs(30000);
             ad_value = get_adc(BATTERY_VOLTS);                     
             send_msg(bcd(ad_value, tempstring));
             send_msg(",");
             DelayMs(20000);                                                    
-            set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-            set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
+            set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
             DelayMs(10000);
             ad_value = get_adc(BATTERY_VOLTS);                     ;
             send_msg(bcd(ad_value, tempstring));
@@ -300,8 +304,7 @@ uint8_t   i, j;
         for (j= 100 ; j>0 ; j -=10) {
             send_msg(bcd(j, tempstring));
             send_msg("% of full speed\r\n");
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, j);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, j);
+            set_motors(MOTOR_FORWARD, j, MOTOR_FORWARD, j);
             DelayMs(5000);
         }    
     }
@@ -323,11 +326,14 @@ uint8_t   i, j;
         for(j=0 ; j<100 ; j++) {
             left_wheel_count = 0;
             right_wheel_count = 0;
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, 60);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, 60);
+            set_motors(MOTOR_FORWARD, 60, MOTOR_FORWARD, 60);
             DelayMs(5000);
-            set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-            set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
+            send_msg("speed ");
+            send_u16(get_wheel_speed(LEFT_MOTOR));
+            send_msg(", ");
+            send_u16(get_wheel_speed(RIGHT_MOTOR));
+            send_msg(" mm/S\r\n");
+            set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
             DelayMs(1000);
             send_msg(bcd((uint8_t)(left_wheel_count), tempstring));
             send_msg(", ");
@@ -458,5 +464,154 @@ uint8_t experiment_10(void) {
 	return 0;
 }
 
+//----------------------------------------------------------------------------
+// experiment_11 : compile a ubasic script into a robot sequence
+// =============
+//
+// Notes
+//      The sequence is verified and listed on the serial port.
+//
+//      Active switches are 
+//          switch A = run compiled sequence
+//          switch C = exit
+//          switch D = save compiled sequence to FLASH
+//
+uint8_t experiment_11(void) {
 
+uint16_t  length;
 
+    length = compile_basic(script2);
+    if (length == 0) {
+        return 1;
+    }
+    if (verify_sequence(shared.RAM_sequence.uint16, length) == FAIL) {
+        return 1;
+    }
+    send_msg("Compiled to ");
+    send_msg(bcd((char)length, tempstring));
+    send_msg(" instructions\r\n");
+    dump_sequence();
+    FOREVER {
+        if (switch_A == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_A);
+            run_sequence(shared.RAM_sequence.uint16);
+            vehicle_stop();
+        }
+        if (switch_D == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_D);
+            if (save_sequence(0) == FLASH_OK) {
+                SOUND_NEXT_SELECTION;
+            } else {
+                SOUND_TAPE_BUMP;
+            }
+        }
+        if (switch_C == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_C);
+            return 0;
+        }
+    }
+}
+
+#if ISR_TIMING
+//----------------------------------------------------------------------------
+// send_timing : send a time in bus clocks as uS, or ">200" for an overrun
+// ===========
+//
+static void send_timing(uint16_t clocks) {
+
+    if (clocks == TIMING_OVERRUN) {
+        send_msg(">200");
+    } else {
+        send_u16(clocks / 20);
+    }
+}
+#endif
+
+//----------------------------------------------------------------------------
+// experiment_12 : ISR execution time and CPU load report
+// =============
+//
+// Notes
+//      Once per second outputs the count/min/mean/max execution time of
+//      each first level ISR (uS), its time histogram, the percentage of
+//      the CPU used by interrupts and the worst case time of each RTI task.
+//      Histogram bins are <5uS, <10uS, <20uS, ... , >=320uS.
+//
+//      Times come from the TPM1 counter, which wraps every 200uS. A time
+//      that could not be measured (a gap of 200uS or more between time
+//      stamps, see isr_timing_start) is an overrun : the ISR max or task
+//      WCET is shown as ">200" and the ISR line gives the overrun count
+//      ("over="). An overrun can also alias to a short time, so figures
+//      with overruns are not reliable. Needs ISR_TIMING set to 1.
+//
+//      Statistics are cleared on entry.
+//
+//      Active switches are 
+//          switch C = exit
+//
+uint8_t experiment_12(void) {
+
+#if ISR_TIMING
+static const char * const isr_names[NOS_TIMED_ISRS] = {"IRQ", "KBI", "RTI", "ADC", "STX", "SRX"};
+
+isr_stats_t   stats;
+uint32_t      busy;
+uint16_t      mean, load;
+uint8_t       i, bin, last_second;
+
+    reset_isr_stats();
+    last_second = second_count;
+    FOREVER {
+        if (switch_C == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_C);
+            return 0;
+        }
+        if (second_count == last_second) {
+            continue;
+        }
+        last_second = second_count;
+        for (i=0 ; i < NOS_TIMED_ISRS ; i++) {
+            DISABLE_INTERRUPTS;
+            stats = isr_stats[i];
+            ENABLE_INTERRUPTS;
+            send_msg((char *)isr_names[i]);
+            send_msg(" n=");
+            send_u16(stats.count);
+            if (stats.count == 0) {
+                send_msg("\r\n");
+                continue;
+            }
+            mean = (uint16_t)(stats.total / stats.count);
+            send_msg(" ");
+            send_u16(stats.min / 20);
+            send_msg("/");
+            send_u16(mean / 20);
+            send_msg("/");
+            send_timing(stats.max);
+            send_msg("uS over=");
+            send_u16(stats.overruns);
+            send_msg("\r\n    ");
+            for (bin = 0 ; bin < ISR_HISTOGRAM_BINS ; bin++) {
+                send_msg(" ");
+                send_u16(stats.histogram[bin]);
+            }
+            send_msg("\r\n");
+        }
+        DISABLE_INTERRUPTS;
+        busy = isr_busy_last_second;
+        ENABLE_INTERRUPTS;
+        load = (uint16_t)(busy / (BUSCLK / 1000));      // parts per thousand
+        send_msg("ISR load = ");
+        send_fixed((int16_t)load, 1);
+        send_msg(" %\r\nTask WCET(uS) ");
+        for (i=0 ; i < NOS_TASKS ; i++) {
+            send_msg(" ");
+            send_timing(task_wcet[i]);
+        }
+        send_msg("\r\n\r\n");
+    }
+#else
+    send_msg("ISR timing not enabled\r\n");
+    return 1;
+#endif
+}
@@ -26,14 +26,26 @@
 //----------------------------------------------------------------------------
 // In RAM subroutine code to manipulate FLASH ROM
 //
-volatile uint8_t PGM[6]  = {  
+// Entry : H:X = FSTAT, A = FCBEF mask
+//         3,SP = wrap count (cleared by caller)
+//
+// While waiting for the command to complete each TPM1 overflow (one
+// motor PWM period) is counted so that the caller can tell how long
+// interrupts were masked.
+//
+volatile uint8_t PGM[14]  = {  
     0xf7,                // sta     ,X       FSTAT  
     0x44,                // lsra          -  delay and convert to FCCF bit
-    0xf5,                // Bit     ,X       FSTAT
-    0x27,0xfd,           // BEQ     *-1
+    0x0f,0x20,0x05,      // brclr   7,TPM1SC,test   TOF clear ?
+    0x1f,0x20,           // bclr    7,TPM1SC        clear TOF
+    0x9e,0x6c,0x03,      // inc     3,SP            count wrap
+    0xf5,                // Bit     ,X       FSTAT  (test)
+    0x27,0xf5,           // BEQ     *-9
     0x81                 // RTS
 }; 
 
+uint8_t     flash_wraps;                // TPM1 wraps during last erase/byte program
+
 //----------------------------------------------------------------------------
 // FlashErasePage : erase a 512 byte block of flash ROM
 // ==============
@@ -53,9 +65,13 @@ uint8_t FlashErasePage(uint16_t page)
         STA       ,X                      ; Save the data
         LDA       #0x40                   ; Erase command   #0x40
         STA       FCMD
+        CLRA
+        PSHA                              ; wrap count      -> 3,SP
         LDA       #FSTAT_FCBEF_MASK
         LDHX      @FSTAT 
         JSR       PGM
+        PULA
+        STA       flash_wraps
         PULA              ; Restore previous status
         TAP
     }
@@ -82,11 +98,132 @@ uint8_t FlashProgramByte(uint16_t address, uint8_t data) {
         STA       ,X         ; Save the data
         LDA       #0x20      ; Burn command  #0x20
         STA       FCMD
+        CLRA
+        PSHA                 ; wrap count  -> 3,SP
         LDA       #FSTAT_FCBEF_MASK
         LDHX      @FSTAT 
         JSR       PGM
+        PULA
+        STA       flash_wraps
         PULA                 ; Restore previous status
         TAP
     }
     return (FSTAT & 0x30);
 }
+
+//----------------------------------------------------------------------------
+// In RAM subroutine code to burst program one row of FLASH ROM
+//
+// Entry : H:X = first flash address
+//         1,SP/2,SP = return address
+//         3,SP/4,SP = source address (RAM)
+//         5,SP      = byte count (1 -> 64)
+//
+// The flash array cannot be read while a command is active so the whole
+// row loop must run from RAM. Each byte is queued as soon as the command
+// buffer is empty (FCBEF) which keeps the high voltage on for the row.
+//
+volatile uint8_t BURST_PGM[52] = {
+    0x89,                // PSHX                    save destination
+    0x8b,                // PSHH
+    0x9e,0xfe,0x05,      // LDHX    5,SP            get source pointer
+    0xf6,                // LDA     ,X
+    0xaf,0x01,           // AIX     #1
+    0x9e,0xff,0x05,      // STHX    5,SP            update source pointer
+    0x8a,                // PULH                    restore destination
+    0x88,                // PULX
+    0xf7,                // STA     ,X              latch data
+    0xaf,0x01,           // AIX     #1
+    0xa6,0x25,           // LDA     #0x25           burst program command
+    0xc7,0x18,0x26,      // STA     FCMD
+    0xa6,0x80,           // LDA     #0x80           launch command
+    0xc7,0x18,0x25,      // STA     FSTAT
+    0xc6,0x18,0x25,      // LDA     FSTAT
+    0xa5,0x30,           // BIT     #0x30           FPVIOL or FACCERR ?
+    0x26,0x12,           // BNE     exit
+    0xc6,0x18,0x25,      // LDA     FSTAT           wait for buffer empty
+    0xa5,0x80,           // BIT     #0x80           FCBEF
+    0x27,0xf9,           // BEQ     *-5
+    0x9e,0x6b,0x05,0xd4, // DBNZ    5,SP,loop       next byte
+    0xc6,0x18,0x25,      // LDA     FSTAT           wait for row complete
+    0xa5,0x40,           // BIT     #0x40           FCCF
+    0x27,0xf9,           // BEQ     *-5
+    0x81                 // RTS
+};
+
+uint16_t    flash_error_address;
+
+static uint16_t    burst_dst, burst_src;
+static uint8_t     burst_count;
+
+//----------------------------------------------------------------------------
+// FlashProgramBlock : burst program a block of erased flash with verify
+// =================
+//
+// Parameters
+//      address : first flash location (must be erased)
+//      src     : pointer to source data (must be in RAM)
+//      length  : number of bytes
+//
+// Description
+//      The block is split on 64 byte row boundaries. Each row is burst
+//      programmed with interrupts masked for that row only (approx 1.5mS
+//      for a full row) and then read back and compared with the source.
+//
+// Returns
+//      FLASH_OK or a FLASH_ERR_xxx code. On error "flash_error_address"
+//      holds the first location of the failing row or the failing byte.
+//
+uint8_t FlashProgramBlock(uint16_t address, uint8_t *src, uint16_t length)
+{
+uint8_t  row_count, i, status;
+
+    if (length == 0) {
+        return FLASH_OK;
+    }
+    if ((uint16_t)(address + length - 1) < address) {
+        flash_error_address = address;
+        return FLASH_ERR_RANGE;
+    }
+    while (length > 0) {
+        row_count = (uint8_t)(ROW_SIZE - (address & (ROW_SIZE - 1)));
+        if (row_count > length) {
+            row_count = (uint8_t)length;
+        }
+        burst_dst = address;
+        burst_src = (uint16_t)src;
+        burst_count = row_count;
+        asm {
+            TPA
+            PSHA                    ; Save current status
+            SEI                     ; Disable interrupts for this row
+            LDA       #0x30
+            STA       FSTAT         ; Clear FACCERR & FPVIOL flags
+            LDA       burst_count
+            PSHA                    ; byte count    -> 5,SP
+            LDHX      burst_src
+            PSHX
+            PSHH                    ; source        -> 3,SP
+            LDHX      burst_dst
+            JSR       BURST_PGM
+            AIS       #3            ; drop parameters
+            PULA                    ; Restore previous status
+            TAP
+        }
+        status = FSTAT & 0x30;
+        if (status != FLASH_OK) {
+            flash_error_address = address;
+            return status;
+        }
+        for (i = 0 ; i < row_count ; i++) {
+            if (*(uint8_t *)(address + i) != src[i]) {
+                flash_error_address = address + i;
+                return FLASH_ERR_VERIFY;
+            }
+        }
+        address += row_count;
+        src += row_count;
+        length -= row_count;
+    }
+    return FLASH_OK;
+}
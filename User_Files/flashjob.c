@@ -0,0 +1,233 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// flashjob.c : queue of flash erase and write jobs run at idle time
+// ==========
+//
+// Description
+//      Flash erase and program commands mask interrupts until they are
+//      complete. A page erase takes about 20mS, which loses RTI ticks :
+//      the display freezes, wheel encoder edges are missed and the tick
+//      counts drift.
+//
+//      Erase and write requests are queued and run by flash_job_poll in
+//      slices. A slice is a page erase or up to FLASH_JOB_SLICE bytes of
+//      programming (about 0.4mS). Each slice starts just after an RTI
+//      tick and only while the robot is stopped. After an erase the TPM1
+//      wraps counted by the flash routine give the time that interrupts
+//      were masked, and the lost ticks are given back by rti_catch_up.
+//      The tick pending when interrupts are unmasked is not lost.
+//
+//      flash_erase and flash_write run one job to completion, for code
+//      that needs the result at once. They fail with FLASH_ERR_BUSY,
+//      leaving nothing queued, if the robot is not stopped.
+//
+// Notes
+//      Foreground use only. The RTI interrupt must be running.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+flash_job_t     flash_jobs[FLASH_JOB_QUEUE_SIZE];
+uint8_t         flash_job_head, flash_job_tail;     // queue in/out counts
+uint8_t         flash_job_status;                   // first error since flash_job_wait started
+uint8_t         flash_job_sync_status;              // result of flash_job_run
+uint16_t        flash_job_ticks_recovered;
+
+//----------------------------------------------------------------------------
+// flash_job_submit : add a job to the queue
+// ================
+//
+// Parameters
+//      type     : FLASH_JOB_ERASE or FLASH_JOB_WRITE
+//      address  : page (erase) or first flash location (write)
+//      src      : data to write (RAM), unused for erase
+//      length   : number of bytes to write, unused for erase
+//      callback : called with FLASH_OK or a FLASH_ERR_xxx code when done
+//
+// Returns
+//      1 if queued, 0 if the queue is full
+//
+uint8_t flash_job_submit(flash_job_type_t type, uint16_t address, uint8_t *src, uint16_t length, flash_job_callback_t callback) {
+
+flash_job_t   *job;
+
+    if ((uint8_t)(flash_job_head - flash_job_tail) >= FLASH_JOB_QUEUE_SIZE) {
+        return 0;
+    }
+    job = &flash_jobs[flash_job_head & (FLASH_JOB_QUEUE_SIZE - 1)];
+    job->type = type;
+    job->address = address;
+    job->src = src;
+    job->length = length;
+    job->callback = callback;
+    flash_job_head++;
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// flash_job_pending : number of jobs not yet complete
+// =================
+//
+uint8_t flash_job_pending(void) {
+
+    return (uint8_t)(flash_job_head - flash_job_tail);
+}
+
+//----------------------------------------------------------------------------
+// flash_job_done : remove the job at the front of the queue
+// ==============
+//
+static void flash_job_done(flash_job_t *job, uint8_t status) {
+
+    if ((status != FLASH_OK) && (flash_job_status == FLASH_OK)) {
+        flash_job_status = status;
+    }
+    flash_job_tail++;
+    if (job->callback != NULL) {
+        job->callback(status);
+    }
+}
+
+//----------------------------------------------------------------------------
+// flash_job_poll : run one slice of the job at the front of the queue
+// ==============
+//
+// Description
+//      Returns at once if there is nothing to do or the robot is moving.
+//      Otherwise waits for the next RTI tick (up to 8mS) and runs one
+//      slice.
+//
+void flash_job_poll(void) {
+
+flash_job_t   *job;
+uint8_t       tick, status, count, lost;
+
+    if ((flash_job_head == flash_job_tail) || (state_of_vehicle != STOPPED)) {
+        return;
+    }
+    tick = tick_count_8;
+    while (tick_count_8 == tick) {
+        ;                                   // slice starts just after a tick
+    }
+    job = &flash_jobs[flash_job_tail & (FLASH_JOB_QUEUE_SIZE - 1)];
+    if (job->type == FLASH_JOB_ERASE) {
+        status = FlashErasePage(job->address);
+        lost = flash_wraps / FLASH_JOB_TICK_WRAPS;
+        if (lost > 0) {
+            lost--;                         // one tick is held pending
+        }
+        rti_catch_up(lost);
+        flash_job_ticks_recovered += lost;
+        flash_job_done(job, status);
+        return;
+    }
+    count = (job->length > FLASH_JOB_SLICE) ? FLASH_JOB_SLICE : (uint8_t)job->length;
+    status = FlashProgramBlock(job->address, job->src, count);
+    job->address += count;
+    job->src += count;
+    job->length -= count;
+    if ((status != FLASH_OK) || (job->length == 0)) {
+        flash_job_done(job, status);
+    }
+}
+
+//----------------------------------------------------------------------------
+// flash_job_wait : run all queued jobs
+// ==============
+//
+// Returns
+//      FLASH_OK, the first FLASH_ERR_xxx code from the jobs, or
+//      FLASH_ERR_BUSY if the robot is moving (jobs are left queued)
+//
+uint8_t flash_job_wait(void) {
+
+    flash_job_status = FLASH_OK;
+    while (flash_job_head != flash_job_tail) {
+        if (state_of_vehicle != STOPPED) {
+            return FLASH_ERR_BUSY;
+        }
+        flash_job_poll();
+    }
+    return flash_job_status;
+}
+
+//----------------------------------------------------------------------------
+// flash_job_sync_done : callback for flash_job_run
+// ===================
+//
+static void flash_job_sync_done(uint8_t status) {
+
+    flash_job_sync_status = status;
+}
+
+//----------------------------------------------------------------------------
+// flash_job_run : run one job to completion
+// =============
+//
+// Returns
+//      FLASH_OK, a FLASH_ERR_xxx code from the job, or FLASH_ERR_BUSY
+//      if the robot is not stopped
+//
+// Notes
+//      Jobs already queued are run first so that this one is at the front
+//      of the queue. If the robot starts to move before the job is done
+//      it is taken off the queue, as src may be on the caller's stack.
+//      Nothing is submitted unless the robot is stopped.
+//
+static uint8_t flash_job_run(flash_job_type_t type, uint16_t address, uint8_t *src, uint16_t length) {
+
+uint8_t   own;
+
+    while (flash_job_head != flash_job_tail) {
+        if (state_of_vehicle != STOPPED) {
+            return FLASH_ERR_BUSY;
+        }
+        flash_job_poll();
+    }
+    if (state_of_vehicle != STOPPED) {
+        return FLASH_ERR_BUSY;
+    }
+    own = flash_job_head;
+    (void)flash_job_submit(type, address, src, length, flash_job_sync_done);
+    while (flash_job_tail == own) {
+        if (state_of_vehicle != STOPPED) {
+            flash_job_tail++;               // withdraw the job
+            return FLASH_ERR_BUSY;
+        }
+        flash_job_poll();
+    }
+    return flash_job_sync_status;
+}
+
+//----------------------------------------------------------------------------
+// flash_erase : erase a page through the job queue and wait
+// ===========
+//
+// Returns
+//      FLASH_OK or a FLASH_ERR_xxx code
+//
+uint8_t flash_erase(uint16_t page) {
+
+    return flash_job_run(FLASH_JOB_ERASE, page, NULL, 0);
+}
+
+//----------------------------------------------------------------------------
+// flash_write : program erased flash through the job queue and wait
+// ===========
+//
+// Returns
+//      FLASH_OK or a FLASH_ERR_xxx code
+//
+// Notes
+//      On FLASH_ERR_BUSY some of the data may have been programmed if
+//      length is more than FLASH_JOB_SLICE bytes.
+//
+uint8_t flash_write(uint16_t address, uint8_t *src, uint16_t length) {
+
+    return flash_job_run(FLASH_JOB_WRITE, address, src, length);
+}
@@ -64,6 +64,7 @@ uint8_t     activity;
 // 
         show_dual_chars('F', ('0'+ activity), 0); 
         push_LED_display();      
+        runlog_start(RUNLOG_ID(FOLLOW_MODE, activity));
         switch (activity) {
                 case LINE_FOLLOW_MODE :                          // in progress
                     run_follow_line_mode();
@@ -74,6 +75,7 @@ uint8_t     activity;
                 default :
                     break;
         }
+        runlog_stop();
         pop_LED_display();
         show_dual_chars('F', ('0'+ activity), (A_TO_FLASH | 10));
         F_MODE_LEDS;            
@@ -197,32 +199,28 @@ mode_state_t  state;
 //      -> go into spin mode
 //        
         if ((line_L == BLACK) && (line_R == BLACK)) {
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-            set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);          
+            set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
         }
 //
 // tape detected by left sensor
 //      -> stop left motor
 //
         if ((line_L == BLACK) && (line_R == WHITE)) {
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, drag_speed);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);     
+            set_motors(MOTOR_FORWARD, drag_speed, MOTOR_FORWARD, gRight_Speed);
         }
 //
 // tape detected by right sensor
 //      -> stop right motor
 //
         if ((line_L == WHITE) && (line_R == BLACK)) {
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, drag_speed);     
+            set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, drag_speed);
         }
 //
 // no line detected 
 //      -> continue to drive forward
 //
         if ((line_L == WHITE) && (line_R == WHITE)) {
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-            set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);                    
+            set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
         }
         DelayMs(sample_time);
     }  // end of FOREVER loop
@@ -272,8 +270,8 @@ mode_state_t  state;
 //
 // read sensors to get ambient light values and comput the difference
 //
-    ambient_L = get_adc(FRONT_SENSOR_L);  
-    ambient_R = get_adc(FRONT_SENSOR_R);
+    ambient_L = get_adc_fresh(FRONT_SENSOR_L);  
+    ambient_R = get_adc_fresh(FRONT_SENSOR_R);
     if (ambient_L > ambient_R) {
         ambient_diff = ambient_L - ambient_R;
     } else {
@@ -313,8 +311,8 @@ mode_state_t  state;
             //
             // recalculate ambient
             //
-            ambient_L = get_adc(FRONT_SENSOR_L);  
-            ambient_R = get_adc(FRONT_SENSOR_R);
+            ambient_L = get_adc_fresh(FRONT_SENSOR_L);  
+            ambient_R = get_adc_fresh(FRONT_SENSOR_R);
             if (ambient_L > ambient_R) {
                 ambient_diff = ambient_L - ambient_R;
             } else {
@@ -374,15 +372,12 @@ mode_state_t  state;
         } else {
             if (light_diff > light_deadband) {
                 if (larger_reading == FRONT_SENSOR_L) {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, drag_speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                    set_motors(MOTOR_FORWARD, drag_speed, MOTOR_FORWARD, gRight_Speed);
                 } else {
-                    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, drag_speed);
+                    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, drag_speed);
                 } 
             } else {
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed); 
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
             } 
         }
         DelayMs(sample_time);            
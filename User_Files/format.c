@@ -0,0 +1,256 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// format.c : number to text conversion without sprintf
+// ========
+//
+// Description
+//      Each fmt_xxx routine writes its text at "buffer", adds a NUL and
+//      returns a pointer to the NUL so that calls can be chained to build
+//      a line, e.g.
+//
+//          p = fmt_str(tempstring, "Left=");
+//          p = fmt_u16(p, left_wheel_count);
+//          send_msg(tempstring);
+//
+//      The send_xxx routines write a number straight to the serial port.
+//
+//      Decimal digits are found by repeated subtraction of powers of ten,
+//      as the HCS08 has no 16 or 32 bit divide instruction. Each digit
+//      costs at most nine subtractions.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+const uint16_t  pow10_16[4] = {10000, 1000, 100, 10};
+const uint32_t  pow10_32[9] = {1000000000, 100000000, 10000000, 1000000,
+                               100000, 10000, 1000, 100, 10};
+const char      hex_digits[16] = "0123456789ABCDEF";
+
+//----------------------------------------------------------------------------
+// fmt_digits16 : convert an unsigned 16-bit value to decimal
+// ============
+//
+// Parameters
+//      buffer : destination
+//      value  : number to convert
+//      width  : minimum number of digits (leading zeros added)
+//
+// Returns
+//      pointer to terminating NUL
+//
+static char *fmt_digits16(char *buffer, uint16_t value, uint8_t width) {
+
+uint8_t   i;
+char      digit;
+uint8_t   started;
+
+    started = 0;
+    for (i = 0 ; i < 4 ; i++) {
+        digit = '0';
+        while (value >= pow10_16[i]) {
+            value -= pow10_16[i];
+            digit++;
+        }
+        if ((digit != '0') || (started != 0) || (width >= (5 - i))) {
+            *buffer++ = digit;
+            started = 1;
+        }
+    }
+    *buffer++ = (char)value + '0';
+    *buffer = '\0';
+    return buffer;
+}
+
+//----------------------------------------------------------------------------
+// fmt_digits32 : convert an unsigned 32-bit value to decimal
+// ============
+//
+// Notes
+//      As fmt_digits16 but for values up to 4294967295
+//
+static char *fmt_digits32(char *buffer, uint32_t value) {
+
+uint8_t   i;
+char      digit;
+uint8_t   started;
+
+    if (value <= 0xFFFF) {
+        return fmt_digits16(buffer, (uint16_t)value, 1);
+    }
+    started = 0;
+    for (i = 0 ; i < 9 ; i++) {
+        digit = '0';
+        while (value >= pow10_32[i]) {
+            value -= pow10_32[i];
+            digit++;
+        }
+        if ((digit != '0') || (started != 0)) {
+            *buffer++ = digit;
+            started = 1;
+        }
+    }
+    *buffer++ = (char)value + '0';
+    *buffer = '\0';
+    return buffer;
+}
+
+//----------------------------------------------------------------------------
+// fmt_str : copy a string
+// =======
+//
+// Returns
+//      pointer to terminating NUL
+//
+char *fmt_str(char *buffer, const char *string) {
+
+    while (*string != '\0') {
+        *buffer++ = *string++;
+    }
+    *buffer = '\0';
+    return buffer;
+}
+
+//----------------------------------------------------------------------------
+// fmt_u8, fmt_u16, fmt_s16, fmt_u32, fmt_s32 : decimal conversion
+// ===========================================
+//
+// Parameters
+//      buffer : destination, at least FORMAT_BUFFER_SIZE characters
+//      value  : number to convert
+//
+// Returns
+//      pointer to terminating NUL
+//
+// Notes
+//      No leading zeros; negative values have a leading '-'
+//
+char *fmt_u8(char *buffer, uint8_t value) {
+
+    return fmt_digits16(buffer, value, 1);
+}
+
+char *fmt_u16(char *buffer, uint16_t value) {
+
+    return fmt_digits16(buffer, value, 1);
+}
+
+char *fmt_s16(char *buffer, int16_t value) {
+
+    if (value < 0) {
+        *buffer++ = '-';
+        return fmt_digits16(buffer, (uint16_t)(-value), 1);
+    }
+    return fmt_digits16(buffer, (uint16_t)value, 1);
+}
+
+char *fmt_u32(char *buffer, uint32_t value) {
+
+    return fmt_digits32(buffer, value);
+}
+
+char *fmt_s32(char *buffer, int32_t value) {
+
+    if (value < 0) {
+        *buffer++ = '-';
+        return fmt_digits32(buffer, (uint32_t)(-value));
+    }
+    return fmt_digits32(buffer, (uint32_t)value);
+}
+
+//----------------------------------------------------------------------------
+// fmt_hex8, fmt_hex16 : hexadecimal conversion
+// ===================
+//
+// Notes
+//      Fixed 2 or 4 upper case digits, no "0x" prefix
+//
+char *fmt_hex8(char *buffer, uint8_t value) {
+
+    *buffer++ = hex_digits[value >> 4];
+    *buffer++ = hex_digits[value & 0x0F];
+    *buffer = '\0';
+    return buffer;
+}
+
+char *fmt_hex16(char *buffer, uint16_t value) {
+
+    buffer = fmt_hex8(buffer, (uint8_t)(value >> 8));
+    return fmt_hex8(buffer, (uint8_t)value);
+}
+
+//----------------------------------------------------------------------------
+// fmt_fixed : convert a scaled integer to fixed point decimal
+// =========
+//
+// Parameters
+//      buffer : destination
+//      value  : number scaled by 10^places
+//      places : digits after the decimal point (1 to 4)
+//
+// Returns
+//      pointer to terminating NUL
+//
+// Notes
+//      fmt_fixed(buffer, -123, 2) gives "-1.23"; fmt_fixed(buffer, 5, 2)
+//      gives "0.05"
+//
+char *fmt_fixed(char *buffer, int16_t value, uint8_t places) {
+
+char      *end;
+uint8_t   i;
+
+    if (value < 0) {
+        *buffer++ = '-';
+        value = -value;
+    }
+    end = fmt_digits16(buffer, (uint16_t)value, places + 1);
+    for (i = 0 ; i <= places ; i++) {           // open a gap for the point
+        end[1 - i] = end[-i];
+    }
+    end[-places] = '.';
+    return end + 1;
+}
+
+//----------------------------------------------------------------------------
+// send_u16, send_s16, send_u32, send_fixed : write a number to the serial port
+// ========================================
+//
+// Notes
+//      Waits if the transmit buffer is full (as send_msg)
+//
+void send_u16(uint16_t value) {
+
+char   buffer[FORMAT_BUFFER_SIZE];
+
+    (void)fmt_u16(buffer, value);
+    send_msg(buffer);
+}
+
+void send_s16(int16_t value) {
+
+char   buffer[FORMAT_BUFFER_SIZE];
+
+    (void)fmt_s16(buffer, value);
+    send_msg(buffer);
+}
+
+void send_u32(uint32_t value) {
+
+char   buffer[FORMAT_BUFFER_SIZE];
+
+    (void)fmt_u32(buffer, value);
+    send_msg(buffer);
+}
+
+void send_fixed(int16_t value, uint8_t places) {
+
+char   buffer[FORMAT_BUFFER_SIZE];
+
+    (void)fmt_fixed(buffer, value, places);
+    send_msg(buffer);
+}
@@ -19,6 +19,7 @@
 uint16_t         gRight_Speed, gLeft_Speed, current_right_speed, current_left_speed, current_speed;
 uint8_t          left_PWM, right_PWM, new_left_PWM, new_right_PWM;
 uint16_t         left_motor_state, right_motor_state;
+uint8_t          left_motor_pwm, right_motor_pwm;
 vehicle_state_t  state_of_vehicle;
 uint16_t         straight_line_speed, turn_speed;
 uint8_t          pwm_differential;
@@ -32,9 +33,9 @@ seven_seg_display_t   display_buff;
 
 char             tempstring[TEMP_STRING_SIZE];
 //
-// In RAM copy FLASH data
+// wheel sensor black/white thresholds (loaded from the key/value store)
 //
-FLASH_data_t   FLASH_data_image;
+uint8_t        left_wheel_threshold, right_wheel_threshold;
 
 //
 // general data area for different types of command data
@@ -219,6 +220,14 @@ union {
 		uint8_t uint8[RAM_SEQUENCE_SIZE * 2];
 	} RAM_sequence;
 	
+	// BASIC compiler workspace : sequence output followed by compiler tables
+	struct {
+		uint16_t sequence[RAM_SEQUENCE_SIZE];
+		uint8_t  line_table[MAX_COMPILE_LINES][2];     // line number, address
+		uint8_t  fixups[MAX_COMPILE_FIXUPS][2];        // GOTO address, line number
+		uint8_t  for_stack[MAX_COMPILE_FORS][2];       // variable, loop address
+	} compile;
+	
 } shared;
 
 
@@ -202,6 +202,9 @@ void Init_sci(void)
     SCI1C1 = 0x00;              //RS232 operation
     SCI1C2 = 0x00;
     SCI1C3 = 0x00;
+    SCI1C2_TE = 1;              //Tx on, bytes sent by sci_tx_isr
+    SCI1C2_RE = 1;              //Rx on, bytes stored by sci_rx_isr
+    SCI1C2_RIE = 1;
 }
 
 //----------------------------------------------------------------------------
@@ -214,8 +217,10 @@ void Init_sci(void)
 // Notes
 //      1. enable appropriate analogue input pins
 //      2. software trigger, disable compare function
-//      3. high speed, clock div 8, short sample, 8-bit conversion and 20MHz busclock input
+//      3. high speed, clock div 8, short sample, 8 or 10-bit conversion (ADC_10BIT)
+//         and 20MHz busclock input
 //      4. disable interrupt, single convert mode, set disable channel input
+//      5. fill sample table ready for the interrupt driven background scan
 //
 void Init_adc(void)
 {
@@ -224,9 +229,15 @@ void Init_adc(void)
 //
     setReg8(ADC1SC2, (AD_CONV_TRIG_SOFT | AD_COMP_FUNC_DIS | AD_COMP_GT_DIS));                      // 0x00   
 //
-    setReg8(ADC1CFG, (AD_HS_EN | AD_CLK_DIV_8 | AD_SHORT_SAMPL | AD_CONV_8BIT | AD_CLK_BUSCLK));    // 0x03
+#if ADC_10BIT
+    setReg8(ADC1CFG, (AD_HS_EN | AD_CLK_DIV_8 | AD_SHORT_SAMPL | AD_CONV_10BIT | AD_CLK_BUSCLK));   // 0x68
+#else
+    setReg8(ADC1CFG, (AD_HS_EN | AD_CLK_DIV_8 | AD_SHORT_SAMPL | AD_CONV_8BIT | AD_CLK_BUSCLK));    // 0x60
+#endif
 //                                          
     setReg8(ADC1SC1, (AD_INT_DIS | AD_SING_CONV | AD_CHAN_DIS));                                    // 0x1F 
+//
+    init_adc_scan();
 }
 
 //----------------------------------------------------------------------------
@@ -14,9 +14,6 @@
 
 #include "global.h"
 
-#define    STACK_SIZE        8         // number of 16-bit elements on the stack
-#define    NOS_VARIABLES    16
-
 //
 // stack to hold data for the robot commands
 //
@@ -39,6 +36,8 @@ uint16_t vars[NOS_VARIABLES];
 //
 uint8_t   sequence_left_speed, sequence_right_speed, sequence_left_direction, sequence_right_direction;
 uint16_t  sequence_time, sequence_distance;
+uint8_t   sequence_running;                 // set while run_sequence executes
+volatile uint8_t  sequence_abort;           // set to end run_sequence early
 
 
     
@@ -71,6 +70,7 @@ int i;
     for (i=0 ; i<STACK_SIZE ; i++) {
         stack.item_16[i] = 0;
     }
+    reset_pose();
 }
 
 //----------------------------------------------------------------------------
@@ -136,6 +136,34 @@ void cmd_push_16(uint16_t value)
     stack_ptr++;    
 }
 
+//----------------------------------------------------------------------------
+// cmd_read_channel : push value of a sensor channel onto the stack
+// ================
+//
+// Description
+//      a/d channels are pushed as 8-bit values, odometry pose channels
+//      as 16-bit values.
+// Parameters
+//      channel : a/d channel number or POSE_xxx_CHAN
+//
+void cmd_read_channel(uint8_t channel) 
+{
+    switch (channel) {
+        case POSE_X_CHAN :
+            cmd_push_16((uint16_t)pose_x_cm());
+            break;
+        case POSE_Y_CHAN :
+            cmd_push_16((uint16_t)pose_y_cm());
+            break;
+        case POSE_HEADING_CHAN :
+            cmd_push_16(pose_heading_deg());
+            break;
+        default :
+            cmd_push_L8(get_adc(channel));
+            break;
+    }
+}
+
 //----------------------------------------------------------------------------
 // cmd_pop_8 : pop an 8-bit value from the low byte of the stack
 // =========
@@ -190,10 +218,52 @@ void decode_command(uint16_t command)
 {
     
     robot_command.op_code  = (uint8_t)((command >> 8) & 0x3F);
-    robot_command.modifier = (uint8_t)((command >> 8) & 0xC0);
+    robot_command.modifier = (uint8_t)((command >> 14) & 0x03);
     robot_command.data     = (uint8_t)((command) & 0xFF);
 }
 
+//----------------------------------------------------------------------------
+// sequence_signed_speeds : get sequence motor settings as signed speeds
+// ======================
+//
+// Parameters
+//      l_speed, r_speed : set to -100% -> 100%, sign = direction,
+//                         0 for MOTOR_OFF or MOTOR_BRAKE
+//
+static int8_t signed_speed(uint8_t direction, uint8_t speed) 
+{
+    switch (direction) {
+        case MOTOR_FORWARD :
+            return (int8_t)speed;
+        case MOTOR_BACKWARD :
+            return -(int8_t)speed;
+        default :
+            return 0;
+    }
+}
+
+static void sequence_signed_speeds(int8_t *l_speed, int8_t *r_speed) 
+{
+    *l_speed = signed_speed(sequence_left_direction, sequence_left_speed);
+    *r_speed = signed_speed(sequence_right_direction, sequence_right_speed);
+}
+
+//----------------------------------------------------------------------------
+// sequence_wait_moves : wait for all queued moves to finish
+// ===================
+//
+// Notes
+//      The last move brakes the motors when it ends (motion.c). Serial
+//      commands are handled while waiting and "sequence_abort" ends the
+//      wait.
+//
+static void sequence_wait_moves(void) 
+{
+    while ((move_done() == 0) && (sequence_abort == 0)) {
+        shell_poll();
+    }
+}
+
 //----------------------------------------------------------------------------
 // run_sequence : run a sequence of robot commands
 // ============
@@ -204,6 +274,16 @@ void decode_command(uint16_t command)
 //      program : array of instructions
 // Results
 //      None
+// Notes
+//      Serial commands are handled between instructions and while waiting.
+//      Setting "sequence_abort" stops the vehicle and ends the sequence.
+//
+//      MOVE_TIME and MOVE_DISTANCE are queued (motion.c) and the sequence
+//      carries on, so that moves in the same direction run on without
+//      stopping. The sequence only waits when the queue is full or before
+//      an instruction that needs the moves to be finished : STOP, EXIT,
+//      START, DRIVE and READ_CHAN (sensor values for TEST_AND_SKIP). A
+//      DELAY with moves pending is queued as a pause.
 //
 void run_sequence(const uint16_t  sequence[]) 
 {
@@ -212,6 +292,8 @@ uint8_t  motor, ad_value, speed_tweak;
 uint16_t time, target_time;
 
     init_for_sequence_execution();
+    sequence_running = 1;
+    sequence_abort = 0;
 //
 // calculate speed tweak from reading from POT_1
 //    
@@ -229,6 +311,14 @@ uint16_t time, target_time;
 // command execute loop
 //    
     FOREVER {
+        shell_poll();                        // serial commands (e.g. "seq stop")
+        if (sequence_abort != 0) {
+            left_motor_tweak = 0;
+            right_motor_tweak = 0;
+            sequence_running = 0;
+            vehicle_stop();
+            return;
+        }
         decode_command(sequence[sequence_ptr]);    
         switch (robot_command.op_code) {
             case PUSH_L8 :
@@ -296,12 +386,21 @@ uint16_t time, target_time;
                 switch (robot_command.data) {
                     case ADD :
                         stack.item_16[stack_ptr-2] = stack.item_16[stack_ptr-1] + stack.item_16[stack_ptr-2];
-                        stack_ptr--;
+                        break;
+                    case SUB :
+                        stack.item_16[stack_ptr-2] = stack.item_16[stack_ptr-2] - stack.item_16[stack_ptr-1];
+                        break;
+                    case AND :
+                        stack.item_16[stack_ptr-2] = stack.item_16[stack_ptr-2] & stack.item_16[stack_ptr-1];
+                        break;
+                    case OR :
+                        stack.item_16[stack_ptr-2] = stack.item_16[stack_ptr-2] | stack.item_16[stack_ptr-1];
                         break;
                 }
+                stack_ptr--;
                 break;
 //
-            case GOTO : 
+            case GOTO :                              // jump straight to target
                 switch (robot_command.modifier) {
                     case ABSOLUTE :
                         sequence_ptr = ((uint8_t)robot_command.data);
@@ -313,7 +412,7 @@ uint16_t time, target_time;
                         sequence_ptr = sequence_ptr - ((uint8_t)robot_command.data);
                         break;
                 }
-                break;
+                continue;                            // skip program counter increment
 //
             case DEC_AND_SKIP :
                 vars[robot_command.data]--;
@@ -325,40 +424,28 @@ uint16_t time, target_time;
             case EXECUTE :
                 switch (robot_command.data) {
                     case MOVE_TIME :
-                        CLR_TIMER16;
-                        set_motor(LEFT_MOTOR, sequence_left_direction, sequence_left_speed);
-                        set_motor(RIGHT_MOTOR, sequence_right_direction, sequence_right_speed);
-                        FOREVER {
-                            GET_TIMER16(time);
-                            if (time > sequence_time) {
-                                vehicle_stop();
-                                break;
-                            }
+                        sequence_signed_speeds(&l_speed, &r_speed);
+                        while ((move_queue_time(sequence_time, l_speed, r_speed) == 0) && (sequence_abort == 0)) {
+                            shell_poll();           // queue full
                         }
                         break;
                     case MOVE_DISTANCE :
-                        if (sequence_left_direction == MOTOR_BACKWARD) {
-                            l_speed = -(int8_t)sequence_left_speed;
-                        } else {
-                            l_speed = (int8_t)sequence_left_speed;
-                        }
-                        if (sequence_right_direction == MOTOR_BACKWARD) {
-                            r_speed = -(int8_t)sequence_right_speed;
-                        } else {
-                            r_speed = (int8_t)sequence_right_speed;
-                        }
-                        if (sequence_left_speed > sequence_right_direction) {
+                        sequence_signed_speeds(&l_speed, &r_speed);
+                        if (abs16(l_speed) > abs16(r_speed)) {
                             motor = LEFT_MOTOR; 
                         } else {
                             motor = RIGHT_MOTOR;
                         }
-                        move_distance(sequence_distance, motor, l_speed, r_speed);
+                        while ((move_queue_distance(sequence_distance, motor, l_speed, r_speed) == 0) && (sequence_abort == 0)) {
+                            shell_poll();           // queue full
+                        }
                         break;
                     case START :
-                        set_motor(LEFT_MOTOR, sequence_left_direction, sequence_left_speed);
-                        set_motor(RIGHT_MOTOR, sequence_right_direction, sequence_right_speed);
+                        sequence_wait_moves();
+                        set_motors(sequence_left_direction, sequence_left_speed, sequence_right_direction, sequence_right_speed);
                         break;
                     case STOP :
+                        sequence_wait_moves();
                         vehicle_stop();
                         break;
                 }
@@ -386,12 +473,13 @@ uint16_t time, target_time;
                 break;
 //
             case READ_CHAN :
+                sequence_wait_moves();
                 switch (robot_command.modifier) {
                     case IMMEDIATE :
-                        cmd_push_L8(get_adc(robot_command.data));
+                        cmd_read_channel((uint8_t)robot_command.data);
                         break;
                     case STACK :
-                        cmd_push_L8(get_adc(cmd_pop_8()));
+                        cmd_read_channel(cmd_pop_8());
                         break;
                 }
                 break;
@@ -404,19 +492,36 @@ uint16_t time, target_time;
                     case STACK :
                         target_time = cmd_pop_16();
                         break;
+                    case TICK_COUNT :
+                        target_time = robot_command.data;
+                        break;
+                }
+                if (move_done() == 0) {
+                    while ((move_queue_time(target_time, 0, 0) == 0) && (sequence_abort == 0)) {
+                        shell_poll();       // pause after the queued moves
+                    }
+                    break;
                 }
                 CLR_TIMER16;
                 FOREVER {
                     GET_TIMER16(time);
-                    if (time > target_time) {
+                    if ((time > target_time) || (sequence_abort != 0)) {
                         break;
                     }
+                    shell_poll();
                 }
                 break;
+//
+            case DRIVE :
+                sequence_wait_moves();
+                set_motors((robot_command.data & 0x03), sequence_left_speed, ((robot_command.data >> 2) & 0x03), sequence_right_speed);
+                break;
 //
             case EXIT :
+                sequence_wait_moves();
                 left_motor_tweak = 0;
                 right_motor_tweak = 0;
+                sequence_running = 0;
                 return;
                 break;
 //
@@ -450,8 +555,85 @@ void store_instruction(uint16_t sequence[], uint8_t inst_ptr, instruction_t inst
 {
 uint16_t temp16;
 
-    temp16 = ((((inst)<<8)&0x3F00) | (((modifier)<<8)&0xC000) | (((data))&0x00FF));
+    temp16 = ((((inst)<<8)&0x3F00) | (((modifier)<<14)&0xC000) | (((data))&0x00FF));
     sequence[inst_ptr] = temp16;
     
     return;    
 }
+
+//----------------------------------------------------------------------------
+// verify_sequence : check a sequence before it is run or saved
+// ===============
+//
+// Description
+//      Static check of each instruction. Checks for unknown op-codes,
+//      variable numbers out of range, jumps outside the sequence and that
+//      the sequence contains an EXIT.  The first error found is reported
+//      on the serial port.
+//
+// Parameters
+//      sequence : array of instructions
+//      length   : number of instructions
+//
+// Returns
+//      OK or FAIL
+//
+uint8_t verify_sequence(const uint16_t sequence[], uint16_t length) 
+{
+uint16_t  i, target;
+uint8_t   exit_found;
+char      *error;
+
+    exit_found = NO;
+    error = NULL;
+    for (i=0 ; (i < length) && (error == NULL) ; i++) {
+        decode_command(sequence[i]);
+        switch (robot_command.op_code) {
+            case PUSH_16 :
+            case PUSH_L8 :
+            case PUSH_H8 :
+                if ((robot_command.modifier == REGISTER) && (robot_command.data >= NOS_VARIABLES)) {
+                    error = "bad variable";
+                }
+                break;
+            case POP_8 :
+            case POP_16 :
+            case DEC_AND_SKIP :
+                if (robot_command.data >= NOS_VARIABLES) {
+                    error = "bad variable";
+                }
+                break;
+            case GOTO :
+                switch (robot_command.modifier) {
+                    case RELATIVE_PLUS :  target = i + robot_command.data; break;
+                    case RELATIVE_MINUS : target = i - robot_command.data; break;
+                    default :             target = robot_command.data;     break;
+                }
+                if (target >= length) {
+                    error = "jump out of range";
+                }
+                break;
+            case EXIT :
+                exit_found = YES;
+                break;
+            default :
+                if (robot_command.op_code > DRIVE) {
+                    error = "bad op-code";
+                }
+                break;
+        }
+    }
+    if ((error == NULL) && (exit_found == NO)) {
+        error = "no EXIT";
+        i = length + 1;
+    }
+    if (error != NULL) {
+        send_msg("Verify error at ");
+        send_msg(bcd((char)(i - 1), tempstring));
+        send_msg(" : ");
+        send_msg(error);
+        send_msg("\r\n");
+        return FAIL;
+    }
+    return OK;
+}
@@ -9,7 +9,7 @@
 //
 //          1. IRQ        : left wheel sensor
 //          2. KBI (P4)   : right wheel sensor
-//          3. RTI        : 8mS timer 
+//          3. RTI        : 8mS timer running a table of background tasks
 //
 // Author                Date          Comment
 //----------------------------------------------------------------------------
@@ -23,13 +23,16 @@
 uint16_t    tick_count_16;           // rolls over after 524.28 seconds (8.7 minutes)
 uint8_t     tick_count_8;            // rolls over after 2.04 seconds
 uint8_t     second_count;            // rolls over after 255 seconds
-uint8_t     tick_for_second_count;
 //
 // switch data
 //
-uint8_t     switch_debounced_state, switch_states[SWITCH_SAMPLES];
-uint8_t     sample_index, debounced_state;
+uint8_t     debounced_state;
+uint8_t     switch_count_0, switch_count_1;             // vertical counter bits
 uint8_t     switch_A, switch_B, switch_C, switch_D, switch_ABCD;
+switch_event_t  switch_events[SWITCH_EVENT_QUEUE_SIZE];
+uint8_t     switch_event_head, switch_event_tail;       // head written by ISR only
+uint8_t     switch_event_overflows;                     // events lost while a consumer waits
+volatile uint8_t  switch_event_waiting;                 // set while wait_switch waits
 //
 // display data
 //
@@ -40,12 +43,21 @@ uint8_t     display_no;
 //
 uint16_t    left_wheel_count, right_wheel_count;
 uint8_t     left_wheel_sensor_value, right_wheel_sensor_value;
-uint8_t     left_speed_index, right_speed_index;
-uint16_t    left_speed_array[64], right_speed_array[64];
 //
 // sound system data
 //
 uint8_t     note_pt, note_duration;
+//
+// ISR timing data
+//
+#if ISR_TIMING
+isr_stats_t   isr_stats[NOS_TIMED_ISRS];
+uint32_t      isr_busy_clocks;              // ISR time in current second
+uint32_t      isr_busy_last_second;         // ISR time in last complete second
+uint16_t      timing_last;                  // TPM1CNT at last time stamp
+uint8_t       timing_wraps;                 // TPM1 wraps seen since isr_timing_start
+uint8_t       timing_overrun;               // a wrap was missed since isr_timing_start
+#endif
 
 
 
@@ -64,8 +76,12 @@ uint8_t     note_pt, note_duration;
 
 interrupt VectorNumber_Virq void Virq1(void) {
 
+uint16_t  start;
+
+    ISR_ENTRY(start);
     IRQ_ACK;                   /* Reset real-time interrupt request flag */
     irq_isr();
+    ISR_EXIT(TIMED_IRQ, start);
 }
 
 //----------------------------------------------------------------------------
@@ -78,8 +94,12 @@ interrupt VectorNumber_Virq void Virq1(void) {
 
 interrupt VectorNumber_Vkeyboard1  void Vkbi1(void) {
 
+uint16_t  start;
+
+    ISR_ENTRY(start);
     KBI_ACK;                   /* Reset KBI interrupt request flag */
     kbi_isr();
+    ISR_EXIT(TIMED_KBI, start);
 }
 
 //----------------------------------------------------------------------------
@@ -92,8 +112,233 @@ interrupt VectorNumber_Vkeyboard1  void Vkbi1(void) {
 
 interrupt VectorNumber_Vrti void Vrti1(void) {
 
+uint16_t  start;
+
+    ISR_ENTRY(start);
     SRTISC_RTIACK = 1;                   /* Reset real-time interrupt request flag */
     rti_isr();
+    ISR_EXIT(TIMED_RTI, start);
+}
+
+//----------------------------------------------------------------------------
+// Vadc   first level interrupt handler for a/d conversion complete.
+// ====
+// 
+// 1. Call interrupt service routine (reading result acknowledges interrupt)
+//----------------------------------------------------------------------------
+
+interrupt VectorNumber_Vadc1 void Vadc(void) {
+
+uint16_t  start;
+
+    ISR_ENTRY(start);
+    adc_isr();
+    ISR_EXIT(TIMED_ADC, start);
+}
+
+//----------------------------------------------------------------------------
+// Vscitx   first level interrupt handler for SCI transmit buffer empty.
+// ======
+// 
+// 1. Call interrupt service routine (writing next byte acknowledges interrupt)
+//----------------------------------------------------------------------------
+
+interrupt VectorNumber_Vsci1tx void Vscitx(void) {
+
+uint16_t  start;
+
+    ISR_ENTRY(start);
+    sci_tx_isr();
+    ISR_EXIT(TIMED_SCI_TX, start);
+}
+
+//----------------------------------------------------------------------------
+// Vscirx   first level interrupt handler for SCI byte received.
+// ======
+// 
+// 1. Call interrupt service routine (reading byte acknowledges interrupt)
+//----------------------------------------------------------------------------
+
+interrupt VectorNumber_Vsci1rx void Vscirx(void) {
+
+uint16_t  start;
+
+    ISR_ENTRY(start);
+    sci_rx_isr();
+    ISR_EXIT(TIMED_SCI_RX, start);
+}
+
+//----------------------------------------------------------------------------
+//----------------------------------------------------------------------------
+// ISR execution time measurement
+// ==============================
+//
+// Description
+//      The first level handlers time stamp entry and exit from TPM1CNT
+//      which counts bus clocks (50nS) and wraps every motor PWM period
+//      (200uS). The TPM1 overflow flag (interrupt not enabled) is polled
+//      and cleared at each time stamp, and the RTI also takes a time stamp
+//      around each task. Wraps are counted from the flag, which can only
+//      show one wrap between two time stamps. If the counter has passed
+//      the previous time stamp value again when a wrap is seen, at least
+//      one wrap was missed and the time is recorded as TIMING_OVERRUN.
+//      So times are exact while no gap between time stamps reaches one
+//      PWM period. A longer gap that happens to end just before the value
+//      at its start can still alias to a short one, so any overrun means
+//      the figures for that ISR or task are not reliable. The time for
+//      the interrupt entry/exit sequence and the timing code itself is
+//      not included.
+//
+// Notes
+//      Set ISR_TIMING to 1 in user_defines.h to include the code.
+//
+#if ISR_TIMING
+//----------------------------------------------------------------------------
+// timing_mark : time stamp from TPM1CNT, counting counter wraps
+// ===========
+//
+static uint16_t timing_mark(void) {
+
+uint16_t   count;
+uint8_t    wraps;
+
+    wraps = 0;
+    if (TPM1SC_TOF == 1) {
+        TPM1SC_TOF = 0;                     // read-modify-write clears overflow flag
+        wraps++;
+    }
+    count = TPM1CNT;
+    if (TPM1SC_TOF == 1) {                  // counter wrapped during the above
+        TPM1SC_TOF = 0;
+        wraps++;
+        count = TPM1CNT;
+    }
+    if ((wraps > 1) || ((wraps == 1) && (count >= timing_last))) {
+        timing_overrun = 1;                 // a full period or more since last stamp
+    }
+    timing_wraps += wraps;
+    timing_last = count;
+    return count;
+}
+
+//----------------------------------------------------------------------------
+// timing_clocks : bus clocks between two time stamps
+// =============
+//
+// Parameters
+//      start, end : values from timing_mark
+//      wraps      : TPM1 wraps counted in between
+//      overrun    : set if a wrap was missed in between
+//
+// Returns
+//      time in bus clocks or TIMING_OVERRUN
+//
+static uint16_t timing_clocks(uint16_t start, uint16_t end, uint8_t wraps, uint8_t overrun) {
+
+    if ((overrun != 0) || (wraps > (TIMING_OVERRUN / (PWM_COUNT + 1)) - 1)) {
+        return TIMING_OVERRUN;
+    }
+    return (uint16_t)((end - start) + (wraps * (PWM_COUNT + 1)));
+}
+#endif
+
+//----------------------------------------------------------------------------
+// isr_timing_start : time stamp ISR entry
+// ================
+//
+uint16_t isr_timing_start(void) {
+
+uint16_t   start;
+
+    start = 0;
+#if ISR_TIMING
+    TPM1SC_TOF = 0;                 // wraps before entry are not counted
+    start = TPM1CNT;
+    if (TPM1SC_TOF == 1) {          // counter wrapped during the above
+        TPM1SC_TOF = 0;
+        start = TPM1CNT;
+    }
+    timing_last = start;
+    timing_wraps = 0;
+    timing_overrun = 0;
+#endif
+    return start;
+}
+
+//----------------------------------------------------------------------------
+// isr_timing_end : time stamp ISR exit and update statistics
+// ==============
+//
+// Parameters
+//      isr   : TIMED_IRQ, TIMED_KBI, TIMED_RTI, TIMED_ADC, TIMED_SCI_TX or TIMED_SCI_RX
+//      start : value from isr_timing_start
+//
+// Notes
+//      An overrun is counted as one PWM period in the totals and falls
+//      in the last histogram bin.
+//
+void isr_timing_end(uint8_t isr, uint16_t start) {
+
+#if ISR_TIMING
+uint16_t     end, time, limit;
+uint8_t      bin;
+isr_stats_t  *stats;
+
+    end = timing_mark();
+    time = timing_clocks(start, end, timing_wraps, timing_overrun);
+    stats = &isr_stats[isr];
+    if (time == TIMING_OVERRUN) {
+        stats->overruns++;
+        stats->max = TIMING_OVERRUN;
+        time = PWM_COUNT + 1;
+        bin = ISR_HISTOGRAM_BINS - 1;
+    } else {
+        if (time > stats->max) {
+            stats->max = time;
+        }
+        limit = ISR_HISTOGRAM_BASE;
+        for (bin = 0 ; (bin < (ISR_HISTOGRAM_BINS - 1)) && (time >= limit) ; bin++) {
+            limit <<= 1;
+        }
+    }
+    if (time < stats->min) {
+        stats->min = time;
+    }
+    if (stats->count != 0xFFFF) {
+        stats->count++;
+        stats->total += time;
+    }
+    if (stats->histogram[bin] != 0xFFFF) {
+        stats->histogram[bin]++;
+    }
+    isr_busy_clocks += time;
+#endif
+}
+
+//----------------------------------------------------------------------------
+// reset_isr_stats : clear ISR timing statistics
+// ===============
+//
+void reset_isr_stats(void) {
+
+#if ISR_TIMING
+uint8_t   i, bin;
+
+    DISABLE_INTERRUPTS;
+    for (i=0 ; i < NOS_TIMED_ISRS ; i++) {
+        isr_stats[i].min = 0xFFFF;
+        isr_stats[i].max = 0;
+        isr_stats[i].total = 0;
+        isr_stats[i].count = 0;
+        isr_stats[i].overruns = 0;
+        for (bin = 0 ; bin < ISR_HISTOGRAM_BINS ; bin++) {
+            isr_stats[i].histogram[bin] = 0;
+        }
+    }
+    isr_busy_clocks = 0;
+    isr_busy_last_second = 0;
+    ENABLE_INTERRUPTS;
+#endif
 }
 
 //----------------------------------------------------------------------------
@@ -135,46 +380,254 @@ void kbi_isr(void) {
     left_wheel_count++;
 }
 
+//----------------------------------------------------------------------------
+// Background task table
+// =====================
+//
+// Each task is run every "period" 8mS ticks. The "phase" offsets the first
+// run so that tasks with the same period do not all land on the same tick.
+// Tasks that count ticks internally step their counters by their period.
+//
+//      task                  period   phase
+//      ----                  ------   -----
+//      ticks                    1       0
+//      display multiplex        1       0     (visible flicker if slower)
+//      wheel encoders           1       0     (limits maximum wheel speed)
+//      tune sequencing          1       0     (note durations are in ticks)
+//      a/d scan start           1       0     (samples at most one tick old)
+//      move profile             4       0     (PID_PERIOD, before speed control)
+//      speed control            1       0     (PID update every PID_PERIOD ticks)
+//      switch debounce          1       0     (4 samples = 32mS debounce)
+//      telemetry                1       0     (frame every telemetry period)
+//      LED flash                4       1
+//      display scroll           4       3
+//      one second tasks       125       5
+//
+// To add a task, write a "void task_xxx(void)" routine and add a line to
+// the table.
+//
+static void task_ticks(void);
+static void task_display_multiplex(void);
+static void task_wheel_encoders(void);
+static void task_tune(void);
+static void task_adc_scan(void);
+static void task_move_profile(void);
+static void task_speed_control(void);
+static void task_switches(void);
+static void task_telemetry(void);
+static void task_LED_flash(void);
+static void task_display_scroll(void);
+static void task_one_second(void);
+
+#define     LED_FLASH_PERIOD        4
+#define     DISPLAY_SCROLL_PERIOD   4
+
+const task_t  task_table[NOS_TASKS] = {
+    { task_ticks,               1,                      0 },
+    { task_display_multiplex,   1,                      0 },
+    { task_wheel_encoders,      1,                      0 },
+    { task_tune,                1,                      0 },
+    { task_adc_scan,            1,                      0 },
+    { task_move_profile,        PID_PERIOD,             0 },
+    { task_speed_control,       1,                      0 },
+    { task_switches,            1,                      0 },
+    { task_telemetry,           1,                      0 },
+    { task_LED_flash,           LED_FLASH_PERIOD,       1 },
+    { task_display_scroll,      DISPLAY_SCROLL_PERIOD,  3 },
+    { task_one_second,          TICKS_IN_ONE_SECOND,    5 },
+};
+
+uint8_t     task_countdown[NOS_TASKS];      // ticks to next run of each task
+#if ISR_TIMING
+uint16_t    task_wcet[NOS_TASKS];           // worst case execution time (bus clocks)
+#endif
+
+//----------------------------------------------------------------------------
+// init_tasks : set start phase of background tasks
+// ==========
+//
+// Notes
+//      Must be called before the RTI interrupt is enabled.
+//
+void init_tasks(void) {
+
+uint8_t   i;
+
+    for (i=0 ; i < NOS_TASKS ; i++) {
+        task_countdown[i] = task_table[i].phase + 1;
+#if ISR_TIMING
+        task_wcet[i] = 0;
+#endif
+    }
+}
+
+//----------------------------------------------------------------------------
+// rti_catch_up : account for RTI ticks lost while interrupts were masked
+// ============
+//
+// Parameters
+//      ticks : number of ticks lost
+//
+// Description
+//      Advances the tick counters and brings forward the tasks that run
+//      less often than every tick, so that timing kept by those tasks
+//      (e.g. second_count) does not drift. A task that becomes overdue
+//      runs on the next tick. Work done every tick (display multiplex,
+//      wheel encoders) cannot be recovered.
+//
+// Notes
+//      Foreground use only.
+//
+void rti_catch_up(uint8_t ticks) {
+
+uint8_t   i;
+
+    if (ticks == 0) {
+        return;
+    }
+    DISABLE_INTERRUPTS;
+    tick_count_16 += ticks;
+    tick_count_8 += ticks;
+    for (i=0 ; i < NOS_TASKS ; i++) {
+        if (task_table[i].period == 1) {
+            continue;
+        }
+        if (task_countdown[i] > ticks) {
+            task_countdown[i] -= ticks;
+        } else {
+            task_countdown[i] = 1;
+        }
+    }
+    ENABLE_INTERRUPTS;
+}
+
 //----------------------------------------------------------------------------
 // rti_isr : handle rti interrupt
 // =======
 //
 // Description
 //      Background timer interrupt occurs every 8ms.
-//      User to schedule a range of timed activities.
-// Notes
-//      rather goes against the idea of making interrupt routines
-//      as small as possible. Not sure if this could be done in a more
-//      efficient manner. 
-//      (need to measure the time this routine takes to execute)
+//      Runs the tasks in "task_table" that are due on this tick. With
+//      ISR_TIMING set, also records the worst case execution time of each
+//      task, or TIMING_OVERRUN for a task that has taken one PWM period
+//      (200uS) or more.
 //        
 //----------------------------------------------------------------------------
 void rti_isr(void) {
-uint8_t   i, tmp;
+
+uint8_t    i;
+#if ISR_TIMING
+uint16_t   start, time;
+uint8_t    wraps, overrun;
+#endif
+
+    for (i=0 ; i < NOS_TASKS ; i++) {
+        if (--task_countdown[i] != 0) {
+            continue;
+        }
+        task_countdown[i] = task_table[i].period;
+#if ISR_TIMING
+        start = timing_mark();
+        wraps = timing_wraps;
+        overrun = timing_overrun;
+        timing_overrun = 0;
+        task_table[i].task();
+        time = timing_mark();
+        time = timing_clocks(start, time, (uint8_t)(timing_wraps - wraps), timing_overrun);
+        timing_overrun |= overrun;
+        if (time > task_wcet[i]) {
+            task_wcet[i] = time;
+        }
+#else
+        task_table[i].task();
+#endif
+    }
+}
+
+//----------------------------------------------------------------------------
+// task_adc_scan : start background a/d scan
+// =============
+//
+// Notes
+//      The scan runs from the a/d interrupt once this RTI interrupt has
+//      finished. Wheel encoders therefore use the previous tick's scan.
+//
+static void task_adc_scan(void) {
+
+    adc_start_scan();
+}
+
+//----------------------------------------------------------------------------
+// task_move_profile : update speed targets of a profiled move
+// =================
+//
+static void task_move_profile(void) {
+
+    move_task();
+}
+
+//----------------------------------------------------------------------------
+// task_speed_control : run closed loop wheel speed control
+// ==================
 //
-// Timer interrupt occurs every 8mS.
+// Notes
+//      Runs after the wheel encoder task so uses this tick's speeds.
 //
-// Task 1 : count 8mS time units
+static void task_speed_control(void) {
+
+    speed_control_task();
+}
+
+//----------------------------------------------------------------------------
+// task_telemetry : send snapshot of sensors and state
+// ==============
+//
+// Notes
+//      Runs after the sensor, speed control and switch tasks.
+//
+static void task_telemetry(void) {
+
+    telemetry_task();
+}
+
+//----------------------------------------------------------------------------
+// task_ticks : count 8mS time units
+// ==========
 // 
 //      System has an 8-bit and 16-bit tick counters.
 //      Can be used by any routines that needs background timing (e.g. timeouts)   
 // 
+static void task_ticks(void) {
+
     tick_count_16++ ; 
     tick_count_8++;
+}
+
+//----------------------------------------------------------------------------
+// task_switches : sample set of switches and debounce
+// =============
 //
-// Task 2 : sample set of switches and debounce
-//          (Note : may not need to be done every 8mS)
+// Description
+//      Vertical counter debouncer. Each port bit has a 2-bit counter held
+//      across "switch_count_0" and "switch_count_1". A counter is reset
+//      while its input matches the debounced state and counts while it
+//      differs; after 4 consecutive differing samples the debounced bit
+//      changes. All switches are handled together in constant time.
 //
-    switch_states[sample_index] = PTCD; 
-    ++sample_index; 
-    switch_debounced_state = 0xff; 
-    for(i=0; i < SWITCH_SAMPLES; i++) { 
-        switch_debounced_state = switch_debounced_state & switch_states[i]; 
-    }
-    debounced_state = switch_debounced_state; 
-    if(sample_index >= SWITCH_SAMPLES) {
-        sample_index = 0; 
+//      Each debounced change is queued as a press or release event.
+//
+static void task_switches(void) {
+
+uint8_t   delta, mask;
+
+    delta = PTCD ^ debounced_state;
+    switch_count_0 = ~(switch_count_0 & delta);
+    switch_count_1 = switch_count_0 ^ (switch_count_1 & delta);
+    delta &= (switch_count_0 & switch_count_1 & ALL_RELEASED);
+    if (delta == 0) {
+        return;
     }
+    debounced_state ^= delta;
     //
     // code to extract switch bits
     //
@@ -183,46 +636,186 @@ uint8_t   i, tmp;
     switch_C = ((debounced_state & 0b00100000) >> 5 )  & 0b00000001;
     switch_D = ((debounced_state & 0b00010000) >> 4 )  & 0b00000001;
     switch_ABCD = debounced_state & 0b00111100;
+    //
+    // queue an event for each changed switch
+    //
+    for (mask = switch_A_MASK ; mask <= switch_C_MASK ; mask <<= 1) {
+        if ((delta & mask) == 0) {
+            continue;
+        }
+        if (((switch_event_head + 1) & (SWITCH_EVENT_QUEUE_SIZE - 1)) == switch_event_tail) {
+            if (switch_event_waiting != 0) {        // full : lose newest event
+                switch_event_overflows++;           // only matters to a consumer
+            }
+            continue;
+        }
+        switch_events[switch_event_head].event = mask | (((debounced_state & mask) != 0) ? SWITCH_RELEASE : SWITCH_PRESS);
+        switch_events[switch_event_head].time = tick_count_16;
+        switch_event_head = (switch_event_head + 1) & (SWITCH_EVENT_QUEUE_SIZE - 1);
+    }
+}
+
+//----------------------------------------------------------------------------
+// init_switches : set switch debounce state to all released
+// =============
+//
+// Notes
+//      Must be called before the RTI interrupt is enabled.
 //
-// Task 3 : implement flashing of LED displays
+void init_switches(void) {
+
+    debounced_state = 0xFF;
+    switch_count_0 = 0xFF;
+    switch_count_1 = 0xFF;
+    switch_A = RELEASED; switch_B = RELEASED; switch_C = RELEASED; switch_D = RELEASED;
+    switch_ABCD = ALL_RELEASED;
+    switch_event_head = 0;
+    switch_event_tail = 0;
+    switch_event_overflows = 0;
+    switch_event_waiting = 0;
+}
+
+//----------------------------------------------------------------------------
+// get_switch_event : take oldest switch event from queue
+// ================
 //
-    temp_flash_count--;                    // decrements every 8mS
-    if (temp_flash_count == 0) {
-        temp_flash_count = flash_count;    // reload flash counter
-    
-        if (LED_flash_map != 0) {            
-            LED_image = LED_image ^ LED_flash_map;
-            PTGD = LED_image;
-        }
+// Parameters
+//      event : where to put the event
+//
+// Returns
+//      1 if an event was returned, 0 if the queue is empty
+//
+uint8_t get_switch_event(switch_event_t *event) {
+
+    if (switch_event_tail == switch_event_head) {
+        return 0;
     }
+    *event = switch_events[switch_event_tail];
+    switch_event_tail = (switch_event_tail + 1) & (SWITCH_EVENT_QUEUE_SIZE - 1);
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// flush_switch_events : discard all queued switch events
+// ===================
 //
-// Task 4 : shift to next characters for dual 7-segment displays
+void flush_switch_events(void) {
+
+    switch_event_tail = switch_event_head;
+}
+
+//----------------------------------------------------------------------------
+// wait_switch : wait for a switch to be pressed or released
+// ===========
+//
+// Description
+//      Used by the WAIT_SWITCH_PRESSED/RELEASED macros. Returns at once if
+//      the switch is already in the required state, otherwise waits for
+//      the matching edge event.
+//
+// Parameters
+//      mask  : switch_n_MASK of the switch
+//      state : PRESSED or RELEASED
+//
+// Notes
+//      Queued events are consumed up to and including the matching one;
+//      later events are left for get_switch_event. Events from before the
+//      wait started are skipped (time stamp check), so an old edge does
+//      not end the wait. Modes that poll switch_X leave the queue to fill,
+//      so overflows are only counted while waiting here.
+//
+void wait_switch(uint8_t mask, uint8_t state) {
+
+switch_event_t  event;
+uint8_t         released, wanted;
+uint16_t        start;
+
+    DISABLE_INTERRUPTS;
+    start = tick_count_16;
+    released = ((debounced_state & mask) != 0) ? RELEASED : PRESSED;
+    ENABLE_INTERRUPTS;
+    if (released == state) {
+        return;
+    }
+    wanted = mask | ((state == RELEASED) ? SWITCH_RELEASE : SWITCH_PRESS);
+    switch_event_waiting = 1;
+    do {
+        while (get_switch_event(&event) == 0)
+            ;
+    } while ((event.event != wanted) || ((int16_t)(event.time - start) < 0));
+    switch_event_waiting = 0;
+}
+
+//----------------------------------------------------------------------------
+// task_LED_flash : implement flashing of LED displays
+// ==============
+//
+static void task_LED_flash(void) {
+
+    if (temp_flash_count > LED_FLASH_PERIOD) {
+        temp_flash_count -= LED_FLASH_PERIOD;       // counts in 8mS units
+        return;
+    }
+    temp_flash_count = flash_count;                 // reload flash counter
+    if (LED_flash_map != 0) {            
+        LED_image = LED_image ^ LED_flash_map;
+        PTGD = LED_image;
+    }
+}
+
+//----------------------------------------------------------------------------
+// task_display_scroll : shift to next characters for dual 7-segment displays
+// ===================
 //
-    if (robot_display.shift_rate != 0) {
-        robot_display.shift_count--;
-        if (robot_display.shift_count == 0) {
-            robot_display.shift_count = robot_display.shift_rate;
-            robot_display.char_ptr++;
-            if (robot_display.char_ptr >= robot_display.char_count){
-                robot_display.char_ptr = 0;
-            } 
+static void task_display_scroll(void) {
+
+    if (display_front->shift_rate != 0) {
+        if (display_shift_count > DISPLAY_SCROLL_PERIOD) {
+            display_shift_count -= DISPLAY_SCROLL_PERIOD;
+            return;
         }
+        display_shift_count = display_front->shift_rate;
+        display_char_ptr++;
+        if (display_char_ptr >= display_front->char_count){
+            display_char_ptr = 0;
+        } 
     }
+}
+
+//----------------------------------------------------------------------------
+// task_display_multiplex : Multiplex dual 7-segment displays : 8mS switching
+// ======================
 //
-// Task 5 : Multiplex dual 7-segment displays : 8mS switching
+// Notes
+//      A frame queued by display_show is taken here, between ticks, with
+//      its starting scroll position. The scroll position is kept in RAM
+//      so that ROM frames can be shown in place.
 //
+static void task_display_multiplex(void) {
+
+    if (display_next != NULL) {
+        display_front = display_next;
+        display_next = NULL;
+        display_char_ptr = display_front->char_ptr;
+        display_shift_count = display_front->shift_count;
+    }
     if (display_no == SEVEN_SEG_A){
         SEG_A_CTRL = 1; SEG_B_CTRL = 0;
-        PTAD = robot_display.data_A[robot_display.char_ptr];
+        PTAD = display_front->data_A[display_char_ptr];
         display_no = SEVEN_SEG_B;
     } else {
         SEG_A_CTRL = 0; SEG_B_CTRL = 1;
-        PTAD = robot_display.data_B[robot_display.char_ptr];
+        PTAD = display_front->data_B[display_char_ptr];
         display_no = SEVEN_SEG_A;
     }
+}
+
+//----------------------------------------------------------------------------
+// task_tune : manage playing of current tune
+// =========
 //
-// Task 6 : manage playing of current tune
-//
+static void task_tune(void) {
+
     if (sound_file.mode == SOUND_ENABLE) { 
         if (note_duration == 0) {       // end of a note or about to start
             if (note_pt == 0) {         // start first note
@@ -250,14 +843,21 @@ uint8_t   i, tmp;
             note_duration--;
         }
     }
+}
+
+//----------------------------------------------------------------------------
+// task_wheel_encoders : Read and process wheel position encoders
+// ===================
 //
-// Task 7 : Read and process wheel position encoders
-//    
-    tmp = interrupt_get_adc(WHEEL_SENSOR_L);
+static void task_wheel_encoders(void) {
+
+uint8_t   tmp, left_edge, right_edge;
+
+    tmp = get_adc(WHEEL_SENSOR_L);
    //
    // threshold value
    //
-    if (tmp < FLASH_data.LEFT_WHEEL_THRESHOLD) {
+    if (tmp < left_wheel_threshold) {
         tmp = BLACK; 
     } else {
         tmp = WHITE;
@@ -265,40 +865,48 @@ uint8_t   i, tmp;
    //
    // check for signal change
    //
+    left_edge = 0;
     if (tmp != left_wheel_sensor_value) {
         left_wheel_count++;
         left_wheel_sensor_value = tmp;
+        left_edge = 1;
     }
    //
    // repeat for right sensor
    // 
-    tmp = interrupt_get_adc(WHEEL_SENSOR_R);
-    if (tmp < FLASH_data.RIGHT_WHEEL_THRESHOLD) {
+    tmp = get_adc(WHEEL_SENSOR_R);
+    if (tmp < right_wheel_threshold) {
         tmp = BLACK; 
     } else {
         tmp = WHITE;
     }
+    right_edge = 0;
     if (tmp != right_wheel_sensor_value) {
         right_wheel_count++;
         right_wheel_sensor_value = tmp;
+        right_edge = 1;
     }   
-//
-// Task 8 : check for 1 second period and run 1 second tasks
-// 
-    if ((tick_for_second_count--) == 0) {
-        tick_for_second_count = TICKS_IN_ONE_SECOND;
-        //
-        //  Task 8.1 : keep second count (rolls over after 255 seconds)
-        //
-        second_count++;
-        //
-        //  Task 8.2 : read wheel counter for speed and store in circular buffer
-        //             buffer stores the last 64 values (last 64 seconds)
-        //
-//        left_speed_array[left_speed_index++] =  left_wheel_count;
-//        left_speed_index &= (sizeof(left_speed_array)/sizeof(uint16_t));         // handle circular buffer pointer
-//        right_speed_array[right_speed_index++] =  right_wheel_count;
-//        right_speed_index &= (sizeof(right_speed_array)/sizeof(uint16_t));       // handle circular buffer pointer
-    }
+   //
+   // time stamp edges, estimate speeds and track position
+   //
+    wheel_speed_update(left_edge, right_edge);
+    odometry_update();
 }
 
+//----------------------------------------------------------------------------
+// task_one_second : run 1 second tasks
+// ===============
+// 
+static void task_one_second(void) {
+    //
+    //  keep second count (rolls over after 255 seconds)
+    //
+    second_count++;
+#if ISR_TIMING
+    //
+    //  total ISR time over last second for CPU load figure
+    //
+    isr_busy_last_second = isr_busy_clocks;
+    isr_busy_clocks = 0;
+#endif
+}
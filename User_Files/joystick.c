@@ -13,6 +13,17 @@
 
 #include "global.h"
 
+//
+// joystick recording state
+//
+uint8_t     record_ptr;         // next free location in RAM sequence
+uint8_t     record_state;       // packed motor states at last change
+uint16_t    record_tick;        // tick_count_16 at last change
+
+#define     NO_RECORD_STATE     0xFF
+#define     RECORD_LIMIT        (RAM_SEQUENCE_SIZE - 2)    // room for STOP and EXIT
+#define     MAX_TENTHS_TICKS    ((255 * 100) / 8)          // longest DELAY IMMEDIATE
+
 //----------------------------------------------------------------------------
 // run_joystick_mode : run one of a set of joystick activities
 // =================
@@ -74,6 +85,12 @@ uint8_t    activity;
                 case JOYSTICK_MODE_3 :                           // done
                     run_joystick_mode_3();
                     break;
+                case JOYSTICK_MODE_4 :
+                    run_joystick_mode_4();
+                    break;
+                case JOYSTICK_MODE_5 :
+                    run_joystick_mode_5();
+                    break;
                 default :
                     break;
         }
@@ -104,7 +121,23 @@ uint8_t    activity;
 //
 void run_joystick_mode_1(void) {
 
+    drive_joystick_mode_1(NO);
+}
+
+//----------------------------------------------------------------------------
+// drive_joystick_mode_1 : drive vehicle from joystick with optional recording
+// =====================
+//
+// Parameters
+//      record : YES to record motor state changes into the RAM sequence
+//
+// Notes
+//      See run_joystick_mode_1 and run_joystick_mode_4
+//
+void drive_joystick_mode_1(uint8_t record) {
+
 uint8_t     ad_value;
+uint8_t     left_state, right_state;
 
     gLeft_Speed = DEFAULT_SPEED;
     gRight_Speed = gLeft_Speed - pwm_differential + DIFFERENTIAL_NULL;
@@ -112,6 +145,9 @@ uint8_t     ad_value;
     set_LED(LED_B, FLASH_ON);
     set_LED(LED_C, FLASH_ON);
     clr_LED(LED_D);    
+    if (record == YES) {
+        record_start();
+    }
 //
 // main loop
 //    
@@ -124,6 +160,9 @@ uint8_t     ad_value;
             push_LED_display();
             set_LED(LED_A, FLASH_ON);
             vehicle_stop();
+            if (record == YES) {
+                record_change(DRIVE_STATES(MOTOR_BRAKE, MOTOR_BRAKE));
+            }
             SOUND_NEXT_SELECTION;
             WAIT_SWITCH_PRESSED(switch_A);
             WAIT_SWITCH_RELEASED(switch_A);
@@ -140,6 +179,9 @@ uint8_t     ad_value;
             pwm_differential = speed_delta[(ad_value >> 4) & 0x0F];;
             gLeft_Speed = straight_line_speed;
             gRight_Speed = straight_line_speed - pwm_differential + DIFFERENTIAL_NULL;
+            if (record == YES) {
+                record_speeds();
+            }
             WAIT_SWITCH_RELEASED(switch_B);
         }
 //
@@ -147,6 +189,9 @@ uint8_t     ad_value;
 //
         if (switch_C == PRESSED) {            //  back to main 
             vehicle_stop();
+            if (record == YES) {
+                record_end();
+            }
             straight_line_speed = DEFAULT_SPEED;
             SOUND_EXIT_SELECTION;
             WAIT_SWITCH_RELEASED(switch_C);
@@ -157,10 +202,13 @@ uint8_t     ad_value;
 //
         ad_value = get_adc(PAD_SWL);
         if (ad_value < (BACKWARD_VALUE + DEADBAND)) {    
+            left_state = MOTOR_BACKWARD;
             set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);     // backward
         } else if (ad_value > (STOP_VALUE - DEADBAND)) {
+            left_state = MOTOR_BRAKE;
             set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);                 // stop
         } else {                                 
+            left_state = MOTOR_FORWARD;
             set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);      // forward
         }   
 //
@@ -168,12 +216,26 @@ uint8_t     ad_value;
 //
         ad_value = get_adc(PAD_SWR);
         if (ad_value < (BACKWARD_VALUE + DEADBAND)) {    
+            right_state = MOTOR_BACKWARD;
             set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);   // backward              
         } else if (ad_value > (STOP_VALUE - DEADBAND)) {        
+            right_state = MOTOR_BRAKE;
             set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);                // stop
         } else {                                 
+            right_state = MOTOR_FORWARD;
             set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);    // forward
         } 
+//
+// log any change of motor state
+//
+        if (record == YES) {
+            if (record_change(DRIVE_STATES(left_state, right_state)) == FAIL) {
+                record = NO;                            // sequence area full
+                record_end();
+                SOUND_TAPE_BUMP;
+                clr_LED(LED_B);
+            }
+        }
     }  /* end of infinite loop */
 }
 
@@ -371,48 +433,232 @@ uint8_t     joystick_mode, last_joystick_mode;
             continue;                               // skip motor setting code
         }
         last_joystick_mode = joystick_mode;
-        set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-        set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);      
+        set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
 //
 //  Now convert joystick values into motor commands
 //
         switch (joystick_mode) {
             case 0 :  // veer to right
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BRAKE, 0);
                 break;
             case 1 :  // move forward
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 break;        
             case 2 :  // veer to left
-                set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                set_motors(MOTOR_BRAKE, 0, MOTOR_FORWARD, gRight_Speed);
                 break;         
             case 4 :  // spin right
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 break;            
             case 5 :  // stop
-                set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-                set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
+                set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
                 break;           
             case 6 :  // spin left
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
                 break;           
             case 8 :  // reverse to right
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_OFF, 0);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_OFF, 0);
                 break;     
             case 9 :  // reverse
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, gLeft_Speed);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BACKWARD, gLeft_Speed, MOTOR_BACKWARD, gRight_Speed);
                 break;      
             case 10 :  // reverse to left
-                set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, gRight_Speed);
+                set_motors(MOTOR_BRAKE, 0, MOTOR_BACKWARD, gRight_Speed);
                 break; 
         }                                
     }
 }
+
+//----------------------------------------------------------------------------
+// run_joystick_mode_4 : drive with joystick and record the run
+// ===================
+//
+// Description
+//      As run_joystick_mode_1 but each change of motor state is stored in
+//      the RAM sequence area as a DRIVE instruction preceded by a DELAY for
+//      the time spent in the previous state. Only changes are stored so a
+//      256 word sequence holds over 100 changes, i.e. several minutes of
+//      normal driving. The recording can be played back with mode 5 or
+//      with the program mode PLAY/SAVE/DUMP commands.
+//
+// Notes
+//      Recording stops (with a bump sound) if the sequence area fills up.
+//
+void run_joystick_mode_4(void) {
+
+    drive_joystick_mode_1(YES);
+}
+
+//----------------------------------------------------------------------------
+// run_joystick_mode_5 : replay a recorded joystick run
+// ===================
+//
+// Notes
+//      Active switches are 
+//          switch A = replay recorded sequence
+//          switch B = dump recorded sequence on serial port
+//          switch C = exit to main slection level
+//          switch D = save recorded sequence to FLASH
+//
+void run_joystick_mode_5(void) {
+
+    set_LED(LED_A, FLASH_ON);
+    set_LED(LED_B, FLASH_ON);
+    set_LED(LED_C, FLASH_ON);
+    set_LED(LED_D, FLASH_ON);
+    
+    FOREVER {
+        if (switch_A == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_A);
+            run_sequence(shared.RAM_sequence.uint16);
+            vehicle_stop();
+        }
+        if (switch_B == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_B);
+            dump_sequence();
+        }
+        if (switch_D == PRESSED) {
+            WAIT_SWITCH_RELEASED(switch_D);
+            if (save_sequence(0) == FLASH_OK) {
+                SOUND_NEXT_SELECTION;
+            } else {
+                SOUND_TAPE_BUMP;
+            }
+        }
+        if (switch_C == PRESSED) {            //  back to main 
+            vehicle_stop();
+            SOUND_EXIT_SELECTION;
+            WAIT_SWITCH_RELEASED(switch_C);
+            return;
+        }  
+    }
+}
+
+//----------------------------------------------------------------------------
+// record_start : clear RAM sequence and start a joystick recording
+// ============
+//
+void record_start(void) {
+
+uint16_t   i;
+
+    for (i=0 ; i < RAM_SEQUENCE_SIZE ; i++) {
+        shared.RAM_sequence.uint16[i] = 0xFFFF;
+    }
+    record_ptr = 0;
+    record_state = NO_RECORD_STATE;
+    record_speeds();
+}
+
+//----------------------------------------------------------------------------
+// record_word : append one instruction to the recording
+// ===========
+//
+// Returns
+//      OK, or FAIL if the sequence area is full
+//
+uint8_t record_word(uint8_t inst, uint8_t modifier, uint8_t data) {
+
+    if (record_ptr >= RECORD_LIMIT) {
+        return FAIL;
+    }
+    store_instruction(shared.RAM_sequence.uint16, record_ptr, inst, modifier, data);
+    record_ptr++;
+    return OK;
+}
+
+//----------------------------------------------------------------------------
+// record_delay : record time spent in the current motor state
+// ============
+//
+// Description
+//      The elapsed ticks since the last change are run length encoded.
+//      Long periods use DELAY IMMEDIATE (0.1 second units) and the
+//      remainder uses DELAY TICK_COUNT (8mS units) so replay timing is
+//      accurate to one tick per change.
+//
+uint8_t record_delay(void) {
+
+uint16_t   now, elapsed;
+uint8_t    tenths;
+
+    GET_TIMER16(now);
+    elapsed = now - record_tick;
+    record_tick = now;
+    if (record_state == NO_RECORD_STATE) {
+        return OK;                                // skip idle time at start
+    }
+    while (elapsed > 255) {
+        if (elapsed > MAX_TENTHS_TICKS) {
+            tenths = 255;
+        } else {
+            tenths = (uint8_t)((elapsed * 2) / 25);
+        }
+        if (record_word(DELAY, IMMEDIATE, tenths) == FAIL) {
+            return FAIL;
+        }
+        elapsed -= (((uint16_t)tenths * 100) / 8);
+    }
+    if (elapsed > 0) {
+        return record_word(DELAY, TICK_COUNT, (uint8_t)elapsed);
+    }
+    return OK;
+}
+
+//----------------------------------------------------------------------------
+// record_change : record a change of motor states
+// =============
+//
+// Parameters
+//      states : motor states packed with DRIVE_STATES()
+//
+uint8_t record_change(uint8_t states) {
+
+    if (states == record_state) {
+        return OK;
+    }
+    if (record_delay() == FAIL) {
+        return FAIL;
+    }
+    record_state = states;
+    return record_word(DRIVE, NO_MOD, states);
+}
+
+//----------------------------------------------------------------------------
+// record_speeds : record the current motor speed settings
+// =============
+//
+uint8_t record_speeds(void) {
+
+    if (record_delay() == FAIL) {
+        return FAIL;
+    }
+    record_word(PUSH_L8, IMMEDIATE, (uint8_t)gLeft_Speed);
+    record_word(PUSH_L8, IMMEDIATE, MOTOR_FORWARD);
+    record_word(PUSH_L8, IMMEDIATE, LEFT_MOTOR);
+    record_word(SET_PARAMETER, NO_MOD, SPEED);
+    record_word(PUSH_L8, IMMEDIATE, (uint8_t)gRight_Speed);
+    record_word(PUSH_L8, IMMEDIATE, MOTOR_FORWARD);
+    record_word(PUSH_L8, IMMEDIATE, RIGHT_MOTOR);
+    if (record_word(SET_PARAMETER, NO_MOD, SPEED) == FAIL) {
+        return FAIL;
+    }
+    if (record_state != NO_RECORD_STATE) {
+        return record_word(DRIVE, NO_MOD, record_state);      // apply new speeds
+    }
+    return OK;
+}
+
+//----------------------------------------------------------------------------
+// record_end : terminate a joystick recording
+// ==========
+//
+// Notes
+//      Space for the final two instructions is always reserved.
+//
+void record_end(void) {
+
+    record_delay();
+    store_instruction(shared.RAM_sequence.uint16, record_ptr, EXECUTE, NO_MOD, STOP); record_ptr++;
+    store_instruction(shared.RAM_sequence.uint16, record_ptr, EXIT,    NO_MOD, NO_DATA); record_ptr++;
+}
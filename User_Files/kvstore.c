@@ -0,0 +1,317 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// kvstore.c : append only key/value store in two flash pages
+// =========
+//
+// Description
+//      Calibration constants are kept as 16-bit values against a small
+//      key number. An update appends a 4 byte record to the active page
+//      rather than erasing and rewriting the page. A read uses a RAM index,
+//      built by kv_init at boot, of the latest record for each key.
+//
+//      When the active page is full the latest record for each key is
+//      copied to the other page (compaction) and that page becomes the
+//      active page. A page is only erased on compaction, so a page
+//      takes KV_RECORDS_PER_PAGE updates per erase.
+//
+//      Page layout
+//          header  : sequence(2 bytes), KV_VERSION, KV_MAGIC
+//          records : key, value(2 bytes MSB first), check
+//
+//      The active page is the valid page with the newest sequence number.
+//      Each header and record is burst programmed in order with its last
+//      byte programmed last, so a write cut short by a reset gives a bad
+//      check or missing magic byte and is ignored at the next boot. A page
+//      with a different KV_VERSION is treated as blank. The
+//      header of a new page is written after its records, so the old page
+//      stays active until compaction is complete.
+//
+// Notes
+//      Flash is erased and written through the flash job queue, so
+//      kv_write fails with FLASH_ERR_BUSY unless the robot is stopped.
+//
+//      The FLASH_KV segment must be placed on two page aligned flash pages
+//      in the linker parameter file.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+#define     KV_VERSION      1               // page format version
+#define     KV_MAGIC        0x4B            // 'K'
+#define     KV_CHECK_SEED   0x5A
+#define     KV_ERASED       0xFF
+#define     KV_NO_RECORD    0
+
+#pragma   DATA_SEG    FLASH_KV
+
+volatile uint8_t    kv_pages[KV_NOS_PAGES][PAGE_SIZE];
+
+#pragma  DATA_SEG    DEFAULT
+
+uint8_t     kv_active_page;
+uint16_t    kv_sequence;                    // sequence number of active page
+uint16_t    kv_next;                        // offset of next free record
+uint16_t    kv_index[KV_MAX_KEYS];          // offset of latest record or KV_NO_RECORD
+uint16_t    kv_erase_count;                 // erases since boot
+uint8_t     kv_bad_records;                 // records failing check in active page
+
+//----------------------------------------------------------------------------
+// kv_check : check byte for a record
+// ========
+//
+static uint8_t kv_check(uint8_t key, uint8_t value_hi, uint8_t value_lo) {
+
+    return (uint8_t)(key ^ value_hi ^ value_lo ^ KV_CHECK_SEED);
+}
+
+//----------------------------------------------------------------------------
+// kv_page_valid : check a page header
+// =============
+//
+// Parameters
+//      page     : 0 or 1
+//      sequence : page sequence number returned here
+//
+// Returns
+//      1 if the header is complete, 0 otherwise
+//
+static uint8_t kv_page_valid(uint8_t page, uint16_t *sequence) {
+
+volatile uint8_t  *header;
+
+    header = kv_pages[page];
+    if ((header[2] != KV_VERSION) || (header[3] != KV_MAGIC)) {
+        return 0;
+    }
+    *sequence = ((uint16_t)header[0] << 8) | header[1];
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// kv_scan : build the RAM index for the active page
+// =======
+//
+// Notes
+//      Scanning stops at the first fully erased record slot. Records with
+//      a bad check byte are skipped.
+//
+static void kv_scan(void) {
+
+volatile uint8_t  *record;
+uint16_t          offset;
+uint8_t           key;
+
+    for (key = 0 ; key < KV_MAX_KEYS ; key++) {
+        kv_index[key] = KV_NO_RECORD;
+    }
+    kv_bad_records = 0;
+    for (offset = KV_RECORD_SIZE ; offset < PAGE_SIZE ; offset += KV_RECORD_SIZE) {
+        record = &kv_pages[kv_active_page][offset];
+        if ((record[0] == KV_ERASED) && (record[1] == KV_ERASED) && 
+            (record[2] == KV_ERASED) && (record[3] == KV_ERASED)) {
+            break;
+        }
+        key = record[0];
+        if ((key == 0) || (key > KV_MAX_KEYS) || 
+            (record[3] != kv_check(key, record[1], record[2]))) {
+            kv_bad_records++;
+            continue;
+        }
+        kv_index[key - 1] = offset;
+    }
+    kv_next = offset;
+}
+
+//----------------------------------------------------------------------------
+// kv_write_header : make a page the active page
+// ===============
+//
+static uint8_t kv_write_header(uint8_t page, uint16_t sequence) {
+
+uint8_t   header[KV_RECORD_SIZE];
+
+    header[0] = (uint8_t)(sequence >> 8);
+    header[1] = (uint8_t)sequence;
+    header[2] = KV_VERSION;
+    header[3] = KV_MAGIC;
+    return flash_write((uint16_t)kv_pages[page], header, KV_RECORD_SIZE);
+}
+
+//----------------------------------------------------------------------------
+// kv_append : program one record into a page
+// =========
+//
+static uint8_t kv_append(uint8_t page, uint16_t offset, uint8_t key, uint16_t value) {
+
+uint8_t   record[KV_RECORD_SIZE];
+
+    record[0] = key;
+    record[1] = (uint8_t)(value >> 8);
+    record[2] = (uint8_t)value;
+    record[3] = kv_check(key, record[1], record[2]);
+    return flash_write((uint16_t)&kv_pages[page][offset], record, KV_RECORD_SIZE);
+}
+
+//----------------------------------------------------------------------------
+// kv_compact : copy the latest records to the other page
+// ==========
+//
+// Returns
+//      KV_OK or a FLASH_ERR_xxx code
+//
+static uint8_t kv_compact(void) {
+
+uint8_t   page, key, status;
+uint16_t  offset, value;
+
+    page = kv_active_page ^ 1;
+    status = flash_erase((uint16_t)kv_pages[page]);
+    kv_erase_count++;
+    if (status != FLASH_OK) {
+        return status;
+    }
+    offset = KV_RECORD_SIZE;
+    for (key = 1 ; key <= KV_MAX_KEYS ; key++) {
+        if (kv_read(key, &value) != KV_OK) {
+            continue;
+        }
+        status = kv_append(page, offset, key, value);
+        if (status != FLASH_OK) {
+            return status;
+        }
+        offset += KV_RECORD_SIZE;
+    }
+    status = kv_write_header(page, kv_sequence + 1);
+    if (status != FLASH_OK) {
+        return status;
+    }
+    kv_active_page = page;
+    kv_sequence++;
+    kv_scan();
+    return KV_OK;
+}
+
+//----------------------------------------------------------------------------
+// kv_init : find the active page and build the RAM index
+// =======
+//
+// Notes
+//      Call once at boot. If neither page has a valid header (first use)
+//      page 1 is treated as full and empty, so the first kv_write
+//      compacts into page 0. Nothing is written to flash here.
+//
+void kv_init(void) {
+
+uint16_t  sequence_0, sequence_1;
+uint8_t   valid_0, valid_1, i;
+
+    kv_erase_count = 0;
+    kv_bad_records = 0;
+    valid_0 = kv_page_valid(0, &sequence_0);
+    valid_1 = kv_page_valid(1, &sequence_1);
+    if ((valid_0 != 0) && (valid_1 != 0)) {
+        if ((int16_t)(sequence_1 - sequence_0) > 0) {
+            valid_0 = 0;
+        } else {
+            valid_1 = 0;
+        }
+    }
+    if (valid_0 != 0) {
+        kv_active_page = 0;
+        kv_sequence = sequence_0;
+    } else if (valid_1 != 0) {
+        kv_active_page = 1;
+        kv_sequence = sequence_1;
+    } else {
+        kv_active_page = 1;
+        kv_sequence = 0;
+        kv_next = PAGE_SIZE;
+        for (i = 0 ; i < KV_MAX_KEYS ; i++) {
+            kv_index[i] = KV_NO_RECORD;
+        }
+        return;
+    }
+    kv_scan();
+}
+
+//----------------------------------------------------------------------------
+// kv_read : get the latest value for a key
+// =======
+//
+// Parameters
+//      key   : 1 -> KV_MAX_KEYS
+//      value : value returned here
+//
+// Returns
+//      KV_OK, KV_ERR_KEY or KV_ERR_NOT_FOUND
+//
+uint8_t kv_read(uint8_t key, uint16_t *value) {
+
+volatile uint8_t  *record;
+
+    if ((key == 0) || (key > KV_MAX_KEYS)) {
+        return KV_ERR_KEY;
+    }
+    if (kv_index[key - 1] == KV_NO_RECORD) {
+        return KV_ERR_NOT_FOUND;
+    }
+    record = &kv_pages[kv_active_page][kv_index[key - 1]];
+    *value = ((uint16_t)record[1] << 8) | record[2];
+    return KV_OK;
+}
+
+//----------------------------------------------------------------------------
+// kv_write : store a new value for a key
+// ========
+//
+// Parameters
+//      key   : 1 -> KV_MAX_KEYS
+//      value : value to store
+//
+// Returns
+//      KV_OK, KV_ERR_KEY or a FLASH_ERR_xxx code
+//
+// Notes
+//      Nothing is written if the value is unchanged. Must not be called
+//      from an interrupt routine.
+//
+uint8_t kv_write(uint8_t key, uint16_t value) {
+
+uint16_t  old_value;
+uint8_t   status;
+
+    if ((key == 0) || (key > KV_MAX_KEYS)) {
+        return KV_ERR_KEY;
+    }
+    if ((kv_read(key, &old_value) == KV_OK) && (old_value == value)) {
+        return KV_OK;
+    }
+    if (kv_next >= PAGE_SIZE) {
+        status = kv_compact();
+        if (status != KV_OK) {
+            return status;
+        }
+    }
+    status = kv_append(kv_active_page, kv_next, key, value);
+    if (status == FLASH_OK) {
+        kv_index[key - 1] = kv_next;
+    }
+    if (status != FLASH_ERR_BUSY) {         // nothing written if busy
+        kv_next += KV_RECORD_SIZE;          // skip a failed slot
+    }
+    return status;
+}
+
+//----------------------------------------------------------------------------
+// kv_free : number of record slots left before the next compaction
+// =======
+//
+uint8_t kv_free(void) {
+
+    return (uint8_t)((PAGE_SIZE - kv_next) / KV_RECORD_SIZE);
+}
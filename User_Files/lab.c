@@ -115,7 +115,8 @@ uint8_t run_lab_mode_0(void)
 {
 mode_state_t  state;
 uint8_t       count_100mS, count_mode; 
-uint16_t      t_count, count_seconds; 
+uint16_t      t_count, t_start, count_seconds; 
+char          *string_end;
 uint32_t      count_mS;
 
     state = MODE_INIT;
@@ -124,6 +125,8 @@ uint32_t      count_mS;
     set_LED(LED_C, FLASH_ON);
     clr_LED(LED_D);
     count_mode = COUNTING_OFF;
+    t_start = 0;
+    bump_watch_start(ADC_CHANNEL_BIT(FRONT_SENSOR_L), SENSE_LOW);
 
 //
 // main loop
@@ -142,6 +145,7 @@ uint32_t      count_mS;
 //
         if (switch_C == PRESSED) {            //  exit mode
             vehicle_stop();
+            bump_watch_stop();
             SOUND_EXIT_SELECTION;
             WAIT_SWITCH_RELEASED(switch_C);
             return 0;
@@ -166,10 +170,12 @@ uint32_t      count_mS;
 //            }
 //        }
 //
-// check for count START signal : clear timer, show cycling display and sound beeps
+// check for count START signal : note time, show cycling display and sound beeps
+// Sensors are watched by the a/d background scan which time stamps the bump.
 // 
-        if ((count_mode == COUNTING_OFF) && (get_adc(FRONT_SENSOR_L) < SENSE_LOW)) {       // start count
-            CLR_TIMER16;
+        if ((count_mode == COUNTING_OFF) && (bump_watch_events() != 0)) {       // start count
+            t_start = bump_watch.time;
+            bump_watch_start(ADC_CHANNEL_BIT(FRONT_SENSOR_R), SENSE_LOW);
             play_tune(&snd_beeps_1);
             display_string("_-^-_", 0);
             count_mode = COUNTING_ON;       
@@ -177,8 +183,9 @@ uint32_t      count_mS;
 //
 // check for count STOP signal; read count and convert to x.y seconds value
 //     
-        if ((count_mode == COUNTING_ON) && (get_adc(FRONT_SENSOR_R) < SENSE_LOW)) {       // start count
-            GET_TIMER16(t_count);
+        if ((count_mode == COUNTING_ON) && (bump_watch_events() != 0)) {       // stop count
+            t_count = bump_watch.time - t_start;
+            bump_watch_start(ADC_CHANNEL_BIT(FRONT_SENSOR_L), SENSE_LOW);
             count_mode = COUNTING_OFF;       
             stop_tune();
             //
@@ -195,7 +202,11 @@ uint32_t      count_mS;
             //
             // print to display
             //
-            sprintf(tempstring, " %u_%u SECS", count_seconds, count_100mS);
+            string_end = fmt_str(tempstring, " ");
+            string_end = fmt_u16(string_end, count_seconds);
+            string_end = fmt_str(string_end, "_");
+            string_end = fmt_u8(string_end, count_100mS);
+            (void)fmt_str(string_end, " SECS");
             display_string(tempstring, 0);
         }  
     }
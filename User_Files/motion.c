@@ -0,0 +1,436 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// motion.c : queued, profiled moves run from the background tick
+// ========
+//
+// Description
+//      Moves are placed in a small queue by the foreground code and are run
+//      one after another by move_task from the RTI. Each move has a speed
+//      (% PWM, sign = direction) for each wheel and ends after
+//
+//          MOVE_BY_TIME     : a number of 8mS ticks
+//          MOVE_BY_DISTANCE : a number of encoder counts on one wheel
+//          MOVE_BY_ANGLE    : a change of heading in degrees (odometry.c)
+//
+//      The speed of the faster wheel follows a trapezoidal profile :
+//
+//          accelerate  : speed rises by MOVE_ACCELERATION
+//          cruise      : at the commanded speed
+//          decelerate  : once the distance left is needed to slow down,
+//                        (v*v - v_end*v_end) >= 2.a.d
+//
+//      and the slower wheel is scaled in proportion. The speeds are passed
+//      as targets to the closed loop speed control (speed_control.c), so
+//      the profile is recalculated at the same rate as the controllers.
+//
+//      If the next move in the queue drives the wheels in the same
+//      directions the current move only slows to the next move's cruise
+//      speed and the next move starts without stopping. Otherwise the
+//      motors are braked at the end of the move. A move of zero speed brakes
+//      for its time.
+//
+//      A distance or angle move with no encoder count for MOVE_STALL_TICKS
+//      brakes the motors and flushes the queue.
+//
+// Notes
+//      The foreground can queue the next moves while the current one runs.
+//      move_queue_empty is set when the queue holds no more moves (the
+//      current move may still be running). move_done() shows when all
+//      moves are complete.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+// agent              19/10/2026      add move queue, time and angle moves
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+move_cmd_t      move_queue[MOVE_QUEUE_SIZE];
+uint8_t         move_queue_head;            // next move to run
+uint8_t         move_queue_tail;            // next free slot
+uint8_t         move_queue_count;
+volatile uint8_t    move_queue_empty;
+
+move_phase_t    move_state;
+move_cmd_t      move_cmd;                   // current move
+uint16_t        move_progress;              // ticks or counts done
+uint32_t        move_turned;                // binary angle turned
+uint32_t        move_target_angle;
+uint16_t        move_start_count;
+uint16_t        move_last_count;
+uint16_t        move_last_heading;
+uint8_t         move_stall_ticks;
+uint16_t        move_cruise_speed;          // mm/S of faster wheel
+uint16_t        move_speed;                 // current profile speed, mm/S
+uint8_t         move_max_percent;
+uint8_t         move_diff_percent;          // |l_speed - r_speed| for angle moves
+
+//----------------------------------------------------------------------------
+// move_enqueue : add a move to the end of the queue
+// ============
+//
+// Parameters
+//      cmd : move to be copied into the queue
+//
+// Returns
+//      1 if the move was queued, 0 if the queue is full
+//
+// Notes
+//      Returns at once. Use move_done to find when all moves have finished.
+//
+uint8_t move_enqueue(const move_cmd_t *cmd) {
+
+    if (move_queue_count >= MOVE_QUEUE_SIZE) {
+        return 0;
+    }
+    DISABLE_INTERRUPTS;
+    move_queue[move_queue_tail] = *cmd;
+    if (++move_queue_tail >= MOVE_QUEUE_SIZE) {
+        move_queue_tail = 0;
+    }
+    move_queue_count++;
+    move_queue_empty = 0;
+    ENABLE_INTERRUPTS;
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// move_queue_time : queue a move for a fixed time
+// ===============
+//
+// Parameters
+//      ticks   : duration in 8mS ticks
+//      l_speed : speed of left motor (-100% -> 100%)
+//      r_speed : speed of right motor (-100% -> 100%)
+//
+// Returns
+//      1 if the move was queued, 0 if the queue is full
+//
+uint8_t move_queue_time(uint16_t ticks, int8_t l_speed, int8_t r_speed) {
+
+move_cmd_t   cmd;
+
+    cmd.type = MOVE_BY_TIME;
+    cmd.limit = ticks;
+    cmd.unit = LEFT_MOTOR;
+    cmd.l_speed = l_speed;
+    cmd.r_speed = r_speed;
+    return move_enqueue(&cmd);
+}
+
+//----------------------------------------------------------------------------
+// move_queue_distance : queue a move for a number of wheel counts
+// ===================
+//
+// Parameters
+//      encoder_counts : number of wheel counts to move
+//      unit           : wheel used for the counts
+//      l_speed        : speed of left motor (-100% -> 100%)
+//      r_speed        : speed of right motor (-100% -> 100%)
+//
+// Returns
+//      1 if the move was queued, 0 if the queue is full
+//
+uint8_t move_queue_distance(uint16_t encoder_counts, motor_t unit, int8_t l_speed, int8_t r_speed) {
+
+move_cmd_t   cmd;
+
+    cmd.type = MOVE_BY_DISTANCE;
+    cmd.limit = encoder_counts;
+    cmd.unit = unit;
+    cmd.l_speed = l_speed;
+    cmd.r_speed = r_speed;
+    return move_enqueue(&cmd);
+}
+
+//----------------------------------------------------------------------------
+// move_queue_angle : queue a turn through an angle
+// ================
+//
+// Parameters
+//      degrees : change of heading, either direction
+//      l_speed : speed of left motor (-100% -> 100%)
+//      r_speed : speed of right motor (-100% -> 100%)
+//
+// Returns
+//      1 if the move was queued, 0 if the queue is full
+//
+// Notes
+//      The wheel speeds must differ for the robot to turn. A move with
+//      equal speeds ends at once.
+//
+uint8_t move_queue_angle(uint16_t degrees, int8_t l_speed, int8_t r_speed) {
+
+move_cmd_t   cmd;
+
+    cmd.type = MOVE_BY_ANGLE;
+    cmd.limit = degrees;
+    cmd.unit = LEFT_MOTOR;
+    cmd.l_speed = l_speed;
+    cmd.r_speed = r_speed;
+    return move_enqueue(&cmd);
+}
+
+//----------------------------------------------------------------------------
+// move_flush : discard all queued moves
+// ==========
+//
+// Notes
+//      The current move is not changed.
+//
+void move_flush(void) {
+
+    DISABLE_INTERRUPTS;
+    move_queue_head = 0;
+    move_queue_tail = 0;
+    move_queue_count = 0;
+    move_queue_empty = 1;
+    ENABLE_INTERRUPTS;
+}
+
+//----------------------------------------------------------------------------
+// move_done : check for end of all moves
+// =========
+//
+// Returns
+//      1 if no move is running or queued, 0 otherwise
+//
+uint8_t move_done(void) {
+
+    if (move_queue_count != 0) {
+        return 0;
+    }
+    return ((move_state == MOVE_IDLE) || (move_state == MOVE_STALLED)) ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+// move_phase : get state of current move
+// ==========
+//
+move_phase_t move_phase(void) {
+
+    return move_state;
+}
+
+//----------------------------------------------------------------------------
+// move_abort : end current move and discard queued moves
+// ==========
+//
+// Notes
+//      The motors are not changed. Called by vehicle_stop.
+//
+void move_abort(void) {
+
+    move_flush();
+    move_state = MOVE_IDLE;
+}
+
+//----------------------------------------------------------------------------
+// move_same_direction : check if two moves drive the wheels the same way
+// ===================
+//
+static uint8_t move_same_direction(const move_cmd_t *a, const move_cmd_t *b) {
+
+    if ((a->l_speed == 0) || (a->r_speed == 0) || (b->l_speed == 0) || (b->r_speed == 0)) {
+        return 0;
+    }
+    return (((a->l_speed < 0) == (b->l_speed < 0)) && ((a->r_speed < 0) == (b->r_speed < 0))) ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------
+// move_end_speed : speed to slow to at the end of the current move
+// ==============
+//
+// Notes
+//      The next move's cruise speed if it can follow on without stopping,
+//      otherwise MOVE_MIN_SPEED.
+//
+static uint16_t move_end_speed(void) {
+
+const move_cmd_t   *next;
+uint8_t            l_percent, r_percent;
+uint16_t           speed;
+
+    if (move_queue_count == 0) {
+        return MOVE_MIN_SPEED;
+    }
+    next = &move_queue[move_queue_head];
+    if (move_same_direction(&move_cmd, next) == 0) {
+        return MOVE_MIN_SPEED;
+    }
+    l_percent = (uint8_t)abs16(next->l_speed);
+    r_percent = (uint8_t)abs16(next->r_speed);
+    speed = (uint16_t)((l_percent > r_percent) ? l_percent : r_percent) * MOVE_MM_PER_PERCENT;
+    if (speed > move_cruise_speed) {
+        speed = move_cruise_speed;
+    }
+    return (speed > MOVE_MIN_SPEED) ? speed : MOVE_MIN_SPEED;
+}
+
+//----------------------------------------------------------------------------
+// move_load_next : take next move from the queue
+// ==============
+//
+// Parameters
+//      speed : profile speed to start from (mm/S)
+//
+// Notes
+//      Called from move_task with a move in the queue.
+//
+static void move_load_next(uint16_t speed) {
+
+uint8_t   l_percent, r_percent;
+
+    move_cmd = move_queue[move_queue_head];
+    if (++move_queue_head >= MOVE_QUEUE_SIZE) {
+        move_queue_head = 0;
+    }
+    if (--move_queue_count == 0) {
+        move_queue_empty = 1;
+    }
+    l_percent = (uint8_t)abs16(move_cmd.l_speed);
+    r_percent = (uint8_t)abs16(move_cmd.r_speed);
+    move_max_percent = (l_percent > r_percent) ? l_percent : r_percent;
+    move_diff_percent = (uint8_t)abs16(move_cmd.l_speed - move_cmd.r_speed);
+    move_progress = 0;
+    move_turned = 0;
+    move_target_angle = ((uint32_t)move_cmd.limit << 16) / 360;
+    move_start_count = wheel_speed[move_cmd.unit].count;
+    move_last_count = (move_cmd.type == MOVE_BY_ANGLE) ? 
+        (wheel_speed[LEFT_MOTOR].count + wheel_speed[RIGHT_MOTOR].count) : move_start_count;
+    move_last_heading = pose.heading;
+    move_stall_ticks = 0;
+    move_cruise_speed = (uint16_t)move_max_percent * MOVE_MM_PER_PERCENT;
+    move_speed = (speed < move_cruise_speed) ? speed : move_cruise_speed;
+    move_state = MOVE_ACCELERATE;
+}
+
+//----------------------------------------------------------------------------
+// move_task : update profile and start queued moves
+// =========
+//
+// Notes
+//      Run from the RTI every PID_PERIOD ticks, before the speed control.
+//
+void move_task(void) {
+
+uint16_t   count, remaining_mm, end_speed;
+uint32_t   remaining, step_mm;
+int16_t    turn;
+
+    if ((move_state == MOVE_IDLE) || (move_state == MOVE_STALLED)) {
+        if (move_queue_count == 0) {
+            return;
+        }
+        move_load_next(MOVE_MIN_SPEED);
+    }
+    //
+    // distance left to run, ending the move when none is left
+    //
+    for (;;) {
+        remaining = 0;
+        if (move_max_percent != 0) {
+            switch (move_cmd.type) {
+                case MOVE_BY_TIME :
+                    if (move_cmd.limit > move_progress) {
+                        remaining = ((uint32_t)(move_cmd.limit - move_progress) * move_speed) / TICKS_IN_ONE_SECOND;
+                        if (remaining == 0) {
+                            remaining = 1;
+                        }
+                    }
+                    move_progress += PID_PERIOD;
+                    break;
+                case MOVE_BY_DISTANCE :
+                    move_progress = wheel_speed[move_cmd.unit].count - move_start_count;
+                    if (move_cmd.limit > move_progress) {
+                        remaining = ((uint32_t)(move_cmd.limit - move_progress) * 1000) / WHEEL_CONSTANT;
+                    }
+                    break;
+                case MOVE_BY_ANGLE :
+                    turn = (int16_t)(pose.heading - move_last_heading);
+                    move_last_heading = pose.heading;
+                    move_turned += (uint16_t)abs16(turn);
+                    if ((move_diff_percent != 0) && (move_target_angle > move_turned)) {
+                        remaining = (((move_target_angle - move_turned) * MOVE_TURN_MM) >> 16);
+                        remaining = (remaining * move_max_percent) / move_diff_percent;
+                        if (remaining == 0) {
+                            remaining = 1;
+                        }
+                    }
+                    break;
+            }
+        } else if ((move_cmd.type == MOVE_BY_TIME) && (move_cmd.limit > move_progress)) {
+            move_progress += PID_PERIOD;            // pause with motors braked
+            set_wheel_targets(0, 0);
+            return;
+        }
+        if (remaining != 0) {
+            break;
+        }
+        //
+        // move complete : follow straight on with the next move if it
+        // goes the same way, otherwise brake
+        //
+        if ((move_queue_count != 0) && (move_same_direction(&move_cmd, &move_queue[move_queue_head]) != 0)) {
+            move_load_next(move_speed);
+            continue;
+        }
+        move_state = MOVE_IDLE;
+        set_wheel_targets(0, 0);                    // brake
+        return;
+    }
+    //
+    // allow for the distance run before the next profile update
+    //
+    step_mm = ((uint32_t)move_speed * (PID_PERIOD * TICK_TIME_IN_MS)) / 1000;
+    remaining = (remaining > step_mm) ? (remaining - step_mm) : 1;
+    remaining_mm = (remaining > 0xFFFF) ? 0xFFFF : (uint16_t)remaining;
+    //
+    // stall check
+    //
+    if (move_cmd.type != MOVE_BY_TIME) {
+        if (move_cmd.type == MOVE_BY_ANGLE) {
+            count = wheel_speed[LEFT_MOTOR].count + wheel_speed[RIGHT_MOTOR].count;
+        } else {
+            count = wheel_speed[move_cmd.unit].count;
+        }
+        if (count != move_last_count) {
+            move_last_count = count;
+            move_stall_ticks = 0;
+        } else {
+            move_stall_ticks += PID_PERIOD;
+            if (move_stall_ticks >= MOVE_STALL_TICKS) {
+                move_state = MOVE_STALLED;
+                move_queue_head = 0;
+                move_queue_tail = 0;
+                move_queue_count = 0;
+                move_queue_empty = 1;
+                set_wheel_targets(0, 0);
+                return;
+            }
+        }
+    }
+    //
+    // profile : decelerate if the distance left is needed to slow down
+    //
+    end_speed = move_end_speed();
+    if ((move_speed > end_speed) && 
+        ((((uint32_t)move_speed * move_speed) - ((uint32_t)end_speed * end_speed)) / (2 * MOVE_DECELERATION) >= remaining_mm)) {
+        move_state = MOVE_DECELERATE;
+        if (move_speed > (end_speed + MOVE_SPEED_STEP)) {
+            move_speed -= MOVE_SPEED_STEP;
+        } else {
+            move_speed = end_speed;
+        }
+    } else if (move_state == MOVE_ACCELERATE) {
+        move_speed += MOVE_SPEED_STEP;
+        if (move_speed >= move_cruise_speed) {
+            move_speed = move_cruise_speed;
+            move_state = MOVE_CRUISE;
+        }
+    }
+    set_wheel_targets((int16_t)(((int32_t)move_speed * move_cmd.l_speed) / move_max_percent),
+                      (int16_t)(((int32_t)move_speed * move_cmd.r_speed) / move_max_percent));
+}
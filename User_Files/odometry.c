@@ -0,0 +1,198 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// odometry.c : dead reckoning of robot position from the wheel encoders
+// ==========
+//
+// Description
+//      Every RTI tick the change in each wheel's encoder count is turned
+//      into a change of position and heading :
+//
+//          d      = (dl + dr) / 2                 (distance of centre)
+//          dtheta = (dr - dl) / wheel base        (anticlockwise +ve)
+//          x     += d.cos(theta + dtheta/2)
+//          y     += d.sin(theta + dtheta/2)
+//
+//      Position is held in mm as Q24.8 fixed point and heading as a 16-bit
+//      binary angle so that it wraps at 360 degrees by itself. sin/cos come
+//      from a quarter wave ROM table. The update uses only multiplies and
+//      shifts.
+//
+//      The encoders cannot sense direction so each count takes the sign
+//      of the last direction its motor was driven.
+//
+// Notes
+//      Geometry from "Robot commands.txt" : 1.53 counts/cm, 13.3cm wheel
+//      base, giving 6.54mm and 2.8 degrees per count.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+pose_t      pose;
+uint16_t    odo_last_count[2];
+int8_t      odo_direction[2];               // +1 forward, -1 backward
+
+//
+// sin(0 -> 90 degrees) x 16384
+//
+const int16_t sin_table[SIN_TABLE_SIZE] = {
+        0,   402,   804,  1205,  1606,  2006,  2404,  2801,
+     3196,  3590,  3981,  4370,  4756,  5139,  5520,  5897,
+     6270,  6639,  7005,  7366,  7723,  8076,  8423,  8765,
+     9102,  9434,  9760, 10080, 10394, 10702, 11003, 11297,
+    11585, 11866, 12140, 12406, 12665, 12916, 13160, 13395,
+    13623, 13842, 14053, 14256, 14449, 14635, 14811, 14978,
+    15137, 15286, 15426, 15557, 15679, 15791, 15893, 15986,
+    16069, 16143, 16207, 16261, 16305, 16340, 16364, 16379,
+    16384
+};
+
+//----------------------------------------------------------------------------
+// sin_q14 : sine of a binary angle
+// =======
+//
+// Parameters
+//      angle : 65536 = 360 degrees
+//
+// Returns
+//      sin(angle) x 16384 (resolution 1.4 degrees)
+//
+int16_t sin_q14(uint16_t angle) {
+
+uint8_t   index;
+
+    index = (uint8_t)(angle >> 8) & 0x3F;
+    switch (angle >> 14) {
+        case 0 :
+            return sin_table[index];
+        case 1 :
+            return sin_table[64 - index];
+        case 2 :
+            return -sin_table[index];
+        default :
+            return -sin_table[64 - index];
+    }
+}
+
+//----------------------------------------------------------------------------
+// cos_q14 : cosine of a binary angle
+// =======
+//
+int16_t cos_q14(uint16_t angle) {
+
+    return sin_q14(angle + ANGLE_90);
+}
+
+//----------------------------------------------------------------------------
+// reset_pose : set position to origin facing along x axis
+// ==========
+//
+void reset_pose(void) {
+
+    DISABLE_INTERRUPTS;
+    pose.x = 0;
+    pose.y = 0;
+    pose.heading = 0;
+    odo_last_count[LEFT_MOTOR] = wheel_speed[LEFT_MOTOR].count;
+    odo_last_count[RIGHT_MOTOR] = wheel_speed[RIGHT_MOTOR].count;
+    odo_direction[LEFT_MOTOR] = 1;
+    odo_direction[RIGHT_MOTOR] = 1;
+    ENABLE_INTERRUPTS;
+}
+
+//----------------------------------------------------------------------------
+// odometry_update : integrate encoder counts into pose
+// ===============
+//
+// Notes
+//      Run from the RTI wheel encoder task every tick after the counts
+//      have been updated.
+//
+void odometry_update(void) {
+
+int16_t    dl, dr, distance, turn;
+uint16_t   count, mid_heading;
+
+    if (left_motor_state == MOTOR_FORWARD) {
+        odo_direction[LEFT_MOTOR] = 1;
+    } else if (left_motor_state == MOTOR_BACKWARD) {
+        odo_direction[LEFT_MOTOR] = -1;
+    }
+    if (right_motor_state == MOTOR_FORWARD) {
+        odo_direction[RIGHT_MOTOR] = 1;
+    } else if (right_motor_state == MOTOR_BACKWARD) {
+        odo_direction[RIGHT_MOTOR] = -1;
+    }
+    count = wheel_speed[LEFT_MOTOR].count;
+    dl = (int16_t)(count - odo_last_count[LEFT_MOTOR]);
+    odo_last_count[LEFT_MOTOR] = count;
+    count = wheel_speed[RIGHT_MOTOR].count;
+    dr = (int16_t)(count - odo_last_count[RIGHT_MOTOR]);
+    odo_last_count[RIGHT_MOTOR] = count;
+    if ((dl == 0) && (dr == 0)) {
+        return;
+    }
+    if (odo_direction[LEFT_MOTOR] < 0) {
+        dl = -dl;
+    }
+    if (odo_direction[RIGHT_MOTOR] < 0) {
+        dr = -dr;
+    }
+    turn = (dr - dl) * (int16_t)ODO_ANGLE_PER_COUNT;
+    distance = (dl + dr) * (int16_t)ODO_HALF_COUNT_MM_Q8;
+    mid_heading = pose.heading + (uint16_t)(turn >> 1);
+    pose.x += ((int32_t)distance * cos_q14(mid_heading)) >> 14;
+    pose.y += ((int32_t)distance * sin_q14(mid_heading)) >> 14;
+    pose.heading += (uint16_t)turn;
+}
+
+//----------------------------------------------------------------------------
+// get_pose : copy current pose
+// ========
+//
+void get_pose(pose_t *current) {
+
+    DISABLE_INTERRUPTS;
+    *current = pose;
+    ENABLE_INTERRUPTS;
+}
+
+//----------------------------------------------------------------------------
+// pose_x_cm : x position in cm
+// =========
+//
+int16_t pose_x_cm(void) {
+
+pose_t   current;
+
+    get_pose(&current);
+    return (int16_t)(current.x / 2560);
+}
+
+//----------------------------------------------------------------------------
+// pose_y_cm : y position in cm
+// =========
+//
+int16_t pose_y_cm(void) {
+
+pose_t   current;
+
+    get_pose(&current);
+    return (int16_t)(current.y / 2560);
+}
+
+//----------------------------------------------------------------------------
+// pose_heading_deg : heading in degrees (0 -> 359, anticlockwise)
+// ================
+//
+uint16_t pose_heading_deg(void) {
+
+pose_t   current;
+
+    get_pose(&current);
+    return (uint16_t)(((uint32_t)current.heading * 360) >> 16);
+}
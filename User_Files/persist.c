@@ -0,0 +1,141 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// persist.c : check persistent flash data at start-up
+// =========
+//
+// Description
+//      Each flash region is checked once at boot by persist_load.
+//
+//      Key/value store : each page header holds a format version and
+//          each record a check byte (kv_init).
+//      Wheel thresholds : loaded into RAM from the key/value store. The
+//          wheel encoder task reads the RAM copies, never the flash.
+//      Sequence 0 : a CRC-16 of the page and the sequence format
+//          version are kept in the key/value store by save_sequence.
+//      Run log : each page header holds a format version and a CRC-16
+//          (runlog_init). Pages that fail are skipped and reused.
+//      FLASH_data : thresholds saved by older firmware, read only. There
+//          is no CRC to check as nothing writes this page now; the
+//          thresholds are range checked and the guard byte must still
+//          be erased (load_wheel_thresholds).
+//
+//      A region that fails its check is replaced by a compiled-in default
+//      (WHEEL_THRESHOLD_DEFAULT, or a sequence holding only EXIT). The
+//      problems are reported on the serial port by persist_report once
+//      interrupts are running.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+uint8_t     persist_thresholds;         // PERSIST_xxx state of wheel thresholds
+uint8_t     persist_sequence_0;         // PERSIST_xxx state of FLASH_seq_0
+
+//----------------------------------------------------------------------------
+// sequence_crc : CRC-16 of sequence 0 in flash
+// ============
+//
+static uint16_t sequence_crc(void) {
+
+    return crc16_update(CRC16_INIT, (const uint8_t *)&FLASH_seq_0.uint8[0], (RAM_SEQUENCE_SIZE * 2));
+}
+
+//----------------------------------------------------------------------------
+// check_sequence : check sequence 0 against its stored CRC and version
+// ==============
+//
+// Returns
+//      PERSIST_OK, PERSIST_LEGACY or PERSIST_DEFAULT
+//
+static uint8_t check_sequence(void) {
+
+uint16_t  crc, version;
+uint8_t   have_crc, have_version;
+
+    have_crc = (uint8_t)(kv_read(KV_SEQ_0_CRC, &crc) == KV_OK);
+    have_version = (uint8_t)(kv_read(KV_SEQ_0_VERSION, &version) == KV_OK);
+    if ((have_crc == 0) && (have_version == 0)) {
+        if (FLASH_seq_0.uint16[0] == 0xFFFF) {
+            return PERSIST_DEFAULT;             // never saved
+        }
+        return PERSIST_LEGACY;
+    }
+    if ((have_crc == 0) || (have_version == 0) || (version != SEQUENCE_FORMAT_VERSION)) {
+        return PERSIST_DEFAULT;
+    }
+    if (crc != sequence_crc()) {
+        return PERSIST_DEFAULT;
+    }
+    return PERSIST_OK;
+}
+
+//----------------------------------------------------------------------------
+// persist_load : check persistent data and load it into RAM
+// ============
+//
+// Notes
+//      Called from user_init before interrupts are enabled. Nothing is
+//      written to flash or the serial port.
+//
+void persist_load(void) {
+
+    kv_init();
+    persist_thresholds = load_wheel_thresholds();
+    persist_sequence_0 = check_sequence();
+}
+
+//----------------------------------------------------------------------------
+// persist_report : report problems found by persist_load
+// ==============
+//
+// Notes
+//      Called once interrupts are running, as send_msg needs the SCI
+//      transmit interrupt.
+//
+void persist_report(void) {
+
+    if (kv_bad_records != 0) {
+        send_msg("FLASH: ");
+        send_u16(kv_bad_records);
+        send_msg(" bad key/value records ignored\r\n");
+    }
+    if (persist_thresholds == PERSIST_DEFAULT) {
+        send_msg("FLASH: wheel thresholds invalid, defaults used\r\n");
+    }
+    if (runlog_bad_pages != 0) {
+        send_msg("FLASH: ");
+        send_u16(runlog_bad_pages);
+        send_msg(" bad run log pages ignored\r\n");
+    }
+    if (persist_sequence_0 == PERSIST_DEFAULT) {
+        send_msg("FLASH: sequence 0 invalid, cleared\r\n");
+    } else if (persist_sequence_0 == PERSIST_LEGACY) {
+        send_msg("FLASH: sequence 0 has no CRC\r\n");
+    }
+}
+
+//----------------------------------------------------------------------------
+// persist_sequence_saved : record the CRC and version of sequence 0
+// ======================
+//
+// Returns
+//      KV_OK or a FLASH_ERR_xxx code
+//
+// Notes
+//      Called by save_sequence after the page has been programmed.
+//
+uint8_t persist_sequence_saved(void) {
+
+uint8_t   status;
+
+    status = kv_write(KV_SEQ_0_VERSION, SEQUENCE_FORMAT_VERSION);
+    if (status == KV_OK) {
+        status = kv_write(KV_SEQ_0_CRC, sequence_crc());
+    }
+    persist_sequence_0 = (status == KV_OK) ? PERSIST_OK : PERSIST_DEFAULT;
+    return status;
+}
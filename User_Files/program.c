@@ -112,7 +112,7 @@ uint8_t run_program_mode_0(void) {
 
 mode_state_t  state;
 sequence_mode_t   seq_mode;
-uint8_t    i;
+uint16_t   i;
 
     state = MODE_INIT;
     seq_mode = FIRST_SEQUENCE_MODE;
@@ -886,8 +886,7 @@ uint16_t  init_time;
         gRight_Speed = speed;
     }
 
-    set_motor(LEFT_MOTOR, MOTOR_FORWARD, gLeft_Speed);
-    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, gRight_Speed);
+    set_motors(MOTOR_FORWARD, gLeft_Speed, MOTOR_FORWARD, gRight_Speed);
             
     set_LED(LED_D, FLASH_OFF);
     play_tune(&snd_beeps_1);
@@ -983,47 +982,56 @@ uint16_t  init_time;
 //                         termination is signaled by a duration of zero
 //
 // Notes
+//      Commands are fed to the motion queue as timed moves, so the next
+//      moves are queued while the current one runs and moves in the same
+//      direction follow on without stopping.
 //
 
 uint8_t play_sequence(void) {
 
 uint8_t  i, duration;
+int8_t   l_speed, r_speed;
 
     for (i=0 ; i < MAX_STRIP_CMDS ; i++) {
         duration = shared.seq.strip_data[i][1];
         switch (shared.seq.strip_data[i][0]) {
             case CMD_STOP :
             case STRIP_CMD_STOP :
-                set_motor(LEFT_MOTOR, MOTOR_BRAKE, 0);
-                set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
                 if (duration == 0) {           // exit if duration is zero
-                    return  0;
+                    i = MAX_STRIP_CMDS;
+                    continue;
                 }
-                DelayMs(duration * 100);          
+                l_speed = 0;
+                r_speed = 0;
                 break;
             case CMD_SPIN_LEFT :
             case STRIP_CMD_SPIN_LEFT :
-                set_motor(LEFT_MOTOR, MOTOR_BACKWARD, STRIP_PLAY_SPIN_SPEED);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, STRIP_PLAY_SPIN_SPEED);
-                DelayMs(duration * 100);          
+                l_speed = -STRIP_PLAY_SPIN_SPEED;
+                r_speed = STRIP_PLAY_SPIN_SPEED;
                 break;
             case CMD_SPIN_RIGHT :
             case STRIP_CMD_SPIN_RIGHT :
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, STRIP_PLAY_SPIN_SPEED);
-                set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, STRIP_PLAY_SPIN_SPEED);
-                DelayMs(duration * 100);          
+                l_speed = STRIP_PLAY_SPIN_SPEED;
+                r_speed = -STRIP_PLAY_SPIN_SPEED;
                 break;
             case CMD_FORWARD :
             case STRIP_CMD_FORWARD :
-                set_motor(LEFT_MOTOR, MOTOR_FORWARD, STRIP_PLAY_FORWARD_SPEED);
-                set_motor(RIGHT_MOTOR, MOTOR_FORWARD, STRIP_PLAY_FORWARD_SPEED);
-                DelayMs(duration * 100);            
+                l_speed = STRIP_PLAY_FORWARD_SPEED;
+                r_speed = STRIP_PLAY_FORWARD_SPEED;
                 break;
             default :
-                return  0;
-                break;  
+                i = MAX_STRIP_CMDS;
+                continue;
+        }
+        while (move_queue_time(((uint16_t)duration * 100) / TICK_TIME_IN_MS, l_speed, r_speed) == 0) {
+            ;
         }
     }
+    while (move_done() == 0) {
+        ;
+    }
+    set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
+    return  0;
 }
 
 //----------------------------------------------------------------------------
@@ -1275,20 +1283,34 @@ uint8_t   line_L, line_R, current_L, current_R, time, cmd_pt, current_cmd, new_c
 //
 // Description
 //      1. erase specified page
-//      2. write byte stream
+//      2. burst program and verify byte stream
+//      3. record CRC and format version for the start-up check
+//
+// Returns
+//      FLASH_OK or FLASH_ERR_xxx error code
 //
 // Notes
+//      Runs through the flash job queue, so fails with FLASH_ERR_BUSY
+//      unless the robot is stopped.
 //  
-void save_sequence(uint8_t flash_seq_no) 
+uint8_t save_sequence(uint8_t flash_seq_no) 
 {
-uint8_t  count;
+uint8_t  status;
 
-    if (flash_seq_no == 0) {
-        FlashErasePage((uint16_t)&FLASH_seq_0.uint8[0]);
-        for (count = 0 ; count < sizeof(shared.RAM_sequence) ; count++) {
-            FlashProgramByte((uint16_t)&FLASH_seq_0.uint8[count], shared.RAM_sequence.uint8[count]); 
-        }
+    if (flash_seq_no != 0) {
+        return FLASH_ERR_RANGE;
+    }
+    status = flash_erase((uint16_t)&FLASH_seq_0.uint8[0]);
+    if (status != FLASH_OK) {
+        flash_error_address = (uint16_t)&FLASH_seq_0.uint8[0];
+        return status;
+    }
+    status = flash_write((uint16_t)&FLASH_seq_0.uint8[0], &shared.RAM_sequence.uint8[0], sizeof(shared.RAM_sequence));
+    if (status != FLASH_OK) {
+        persist_sequence_0 = PERSIST_DEFAULT;
+        return status;
     }
+    return persist_sequence_saved();
 }
 
 //----------------------------------------------------------------------------
@@ -1298,10 +1320,17 @@ uint8_t  count;
 // Description
 //
 // Notes
+//      If the start-up check found the flash copy corrupt an empty
+//      sequence (EXIT only) is loaded instead.
 //  
 void load_sequence(uint8_t flash_seq_no) 
 {
     if (flash_seq_no == 0) {
+        if (persist_sequence_0 == PERSIST_DEFAULT) {
+            memset(&shared.RAM_sequence.uint8[0], 0xFF, (RAM_SEQUENCE_SIZE*2));
+            shared.RAM_sequence.uint16[0] = INSTRUCTION(EXIT, NO_MOD, NO_DATA);
+            return;
+        }
         memcpy(&shared.RAM_sequence.uint8[0], &FLASH_seq_0.uint8[0],  (RAM_SEQUENCE_SIZE*2)); 
     }
 }
@@ -1316,10 +1345,10 @@ void load_sequence(uint8_t flash_seq_no)
 //  
 void dump_sequence(void) 
 {
-uint8_t    i;
+uint16_t   i;
 
     send_msg("Robot commands in RAM sequence 0\r\n");
-    for (i=0 ; i < (sizeof(shared.RAM_sequence.uint16)) ; i++) {
+    for (i=0 ; i < RAM_SEQUENCE_SIZE ; i++) {
         if (shared.RAM_sequence.uint16[i] == 0xFFFF) {   // unused entries show as all 1's
             break;
         };
@@ -0,0 +1,411 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// runlog.c : log run events to flash for later analysis
+// ========
+//
+// Description
+//      While a bump, follow or sketch activity runs, events are logged
+//      as 8 byte records holding the ticks since the last record, an
+//      event code, the motor states and the three front sensor readings.
+//      Motor state changes are logged automatically.
+//
+//      Records are collected in a small RAM buffer. runlog_idle, called
+//      from DelayMs and the mode menu loop, programs them into flash at
+//      most one row at a time. A row takes about 1.5mS with interrupts
+//      masked, so the control tasks are delayed but never skipped.
+//
+//      The RUNLOG_NOS_PAGES pages of the FLASH_LOG segment are used as a
+//      ring. Each page starts with a RUNLOG_PAGE header holding a page
+//      sequence number, so the newest page is found at boot. The header
+//      also holds the record format version and a CRC-16 of its first
+//      four bytes; a page whose header fails the check is not dumped
+//      and is reused. A page is
+//      only erased while the robot is stopped (runlog_start erases the
+//      next page ahead). If the log reaches an unerased page during a
+//      run, records wait in RAM until the robot stops. Records that
+//      do not fit in the RAM buffer are counted in "runlog_dropped".
+//
+//      runlog_dump sends the whole log, oldest first, on the serial port
+//      as comma separated lines.
+//
+// Notes
+//      All routines are for foreground use only.
+//
+//      The FLASH_LOG segment must be placed on RUNLOG_NOS_PAGES page
+//      aligned flash pages in the linker parameter file.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+#define     RUNLOG_MAGIC            0xA5        // last byte of a page header
+#define     RUNLOG_VERSION          1           // change if the record format changes
+#define     RUNLOG_HEADER_CRC_SIZE  4           // header bytes covered by the CRC
+#define     RUNLOG_ERASED           0xFF
+#define     RUNLOG_PER_PAGE         (PAGE_SIZE / RUNLOG_RECORD_SIZE)
+#define     RUNLOG_PER_ROW          (ROW_SIZE / RUNLOG_RECORD_SIZE)
+
+#pragma   DATA_SEG    FLASH_LOG
+
+volatile runlog_record_t    runlog_pages[RUNLOG_NOS_PAGES][RUNLOG_PER_PAGE];
+
+#pragma  DATA_SEG    DEFAULT
+
+runlog_record_t     runlog_buffer[RUNLOG_BUFFER_RECORDS];
+uint8_t             runlog_head, runlog_tail;   // buffer in/out counts
+
+uint8_t     runlog_page;                // page being written
+uint8_t     runlog_slot;                // next free record in page
+uint16_t    runlog_sequence;            // sequence number of page being written
+uint8_t     runlog_next_erased;         // page after runlog_page is blank
+uint8_t     runlog_running;
+uint8_t     runlog_last_motors;
+uint16_t    runlog_last_tick;
+uint16_t    runlog_dropped;
+uint8_t     runlog_bad_pages;           // pages with a bad header at boot
+
+//----------------------------------------------------------------------------
+// runlog_header_crc : CRC-16 of the checked part of a page header
+// =================
+//
+static uint16_t runlog_header_crc(const runlog_record_t *header) {
+
+    return crc16_update(CRC16_INIT, (const uint8_t *)header, RUNLOG_HEADER_CRC_SIZE);
+}
+
+//----------------------------------------------------------------------------
+// runlog_header_valid : check a page header
+// ===================
+//
+// Notes
+//      Checks the event code, magic byte, format version and CRC.
+//
+static uint8_t runlog_header_valid(uint8_t page) {
+
+runlog_record_t   header;
+
+    header = *(runlog_record_t *)&runlog_pages[page][0];
+    if ((header.event != RUNLOG_PAGE) || (header.sensor[2] != RUNLOG_MAGIC) || 
+        (header.data != RUNLOG_VERSION)) {
+        return 0;
+    }
+    return (uint8_t)((((uint16_t)header.sensor[0] << 8) | header.sensor[1]) == runlog_header_crc(&header));
+}
+
+//----------------------------------------------------------------------------
+// runlog_page_blank : check that a page is fully erased
+// =================
+//
+static uint8_t runlog_page_blank(uint8_t page) {
+
+volatile uint8_t  *byte;
+uint16_t          i;
+
+    byte = (volatile uint8_t *)runlog_pages[page];
+    for (i = 0 ; i < PAGE_SIZE ; i++) {
+        if (byte[i] != RUNLOG_ERASED) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// runlog_next_page : page after a page in the ring
+// ================
+//
+static uint8_t runlog_next_page(uint8_t page) {
+
+    page++;
+    return (page >= RUNLOG_NOS_PAGES) ? 0 : page;
+}
+
+//----------------------------------------------------------------------------
+// runlog_motors : current motor states as a byte
+// =============
+//
+static uint8_t runlog_motors(void) {
+
+    return (uint8_t)((left_motor_state << 4) | (right_motor_state & 0x0F));
+}
+
+//----------------------------------------------------------------------------
+// runlog_erase_next : erase the page after the one being written
+// =================
+//
+// Notes
+//      Runs through the flash job queue, so only works when stopped.
+//
+static void runlog_erase_next(void) {
+
+    if (runlog_next_erased != 0) {
+        return;
+    }
+    if (flash_erase((uint16_t)runlog_pages[runlog_next_page(runlog_page)]) == FLASH_OK) {
+        runlog_next_erased = 1;
+    }
+}
+
+//----------------------------------------------------------------------------
+// runlog_init : find where the log ends
+// ===========
+//
+// Notes
+//      Call once at boot. The page being written is the valid page with
+//      the newest sequence number. With no valid page the log starts at
+//      page 0 on the first write.
+//
+void runlog_init(void) {
+
+uint8_t   page, found;
+uint16_t  sequence;
+
+    runlog_head = 0;
+    runlog_tail = 0;
+    runlog_running = 0;
+    runlog_dropped = 0;
+    runlog_bad_pages = 0;
+    found = 0;
+    runlog_page = RUNLOG_NOS_PAGES - 1;
+    runlog_sequence = 0;
+    for (page = 0 ; page < RUNLOG_NOS_PAGES ; page++) {
+        if (runlog_header_valid(page) == 0) {
+            if (runlog_page_blank(page) == 0) {
+                runlog_bad_pages++;
+            }
+            continue;
+        }
+        sequence = runlog_pages[page][0].delta;
+        if ((found == 0) || ((int16_t)(sequence - runlog_sequence) > 0)) {
+            runlog_page = page;
+            runlog_sequence = sequence;
+            found = 1;
+        }
+    }
+    if (found == 0) {
+        runlog_slot = RUNLOG_PER_PAGE;          // page 0 used on first write
+    } else {
+        for (runlog_slot = 1 ; runlog_slot < RUNLOG_PER_PAGE ; runlog_slot++) {
+            if (runlog_pages[runlog_page][runlog_slot].event == RUNLOG_ERASED) {
+                break;
+            }
+        }
+    }
+    runlog_next_erased = runlog_page_blank(runlog_next_page(runlog_page));
+}
+
+//----------------------------------------------------------------------------
+// runlog_start : start logging a run
+// ============
+//
+// Parameters
+//      run_id : RUNLOG_ID(mode, activity)
+//
+// Notes
+//      Call with the robot stopped, as the next flash page may be erased.
+//
+void runlog_start(uint8_t run_id) {
+
+    runlog_erase_next();
+    DISABLE_INTERRUPTS;
+    runlog_last_tick = tick_count_16;
+    ENABLE_INTERRUPTS;
+    runlog_last_motors = runlog_motors();
+    runlog_running = 1;
+    runlog_event(RUNLOG_RUN_START, run_id);
+}
+
+//----------------------------------------------------------------------------
+// runlog_stop : end logging a run
+// ===========
+//
+// Notes
+//      Buffered records are written by later calls to runlog_idle.
+//
+void runlog_stop(void) {
+
+    if (runlog_running == 0) {
+        return;
+    }
+    runlog_event(RUNLOG_RUN_END, 0);
+    runlog_running = 0;
+}
+
+//----------------------------------------------------------------------------
+// runlog_event : add a record to the RAM buffer
+// ============
+//
+// Parameters
+//      event : RUNLOG_xxx event code
+//      data  : event specific byte
+//
+// Notes
+//      Ignored unless a run is being logged.
+//
+void runlog_event(uint8_t event, uint8_t data) {
+
+runlog_record_t   *record;
+uint16_t          now;
+
+    if (runlog_running == 0) {
+        return;
+    }
+    if ((uint8_t)(runlog_head - runlog_tail) >= RUNLOG_BUFFER_RECORDS) {
+        runlog_dropped++;
+        return;
+    }
+    DISABLE_INTERRUPTS;
+    now = tick_count_16;
+    ENABLE_INTERRUPTS;
+    record = &runlog_buffer[runlog_head & (RUNLOG_BUFFER_RECORDS - 1)];
+    record->event = event;
+    record->data = data;
+    record->delta = now - runlog_last_tick;
+    record->motors = runlog_motors();
+    record->sensor[0] = get_adc(FRONT_SENSOR_L);
+    record->sensor[1] = get_adc(FRONT_SENSOR_C);
+    record->sensor[2] = get_adc(FRONT_SENSOR_R);
+    runlog_last_tick = now;
+    runlog_head++;
+}
+
+//----------------------------------------------------------------------------
+// runlog_idle : background work for the logger
+// ===========
+//
+// Description
+//      Logs a motor state change, then does at most one flash operation :
+//      programs buffered records up to the end of the current row, or
+//      starts a new page when the current one is full.
+//
+void runlog_idle(void) {
+
+runlog_record_t   header;
+uint8_t           count, space;
+uint16_t          crc;
+
+    if ((runlog_running != 0) && (runlog_motors() != runlog_last_motors)) {
+        runlog_last_motors = runlog_motors();
+        runlog_event(RUNLOG_MOTORS, 0);
+    }
+    if (runlog_head == runlog_tail) {
+        return;
+    }
+    if (runlog_slot >= RUNLOG_PER_PAGE) {
+        if (runlog_next_erased == 0) {
+            if (state_of_vehicle != STOPPED) {
+                return;                     // wait until the robot stops
+            }
+            runlog_erase_next();
+            return;
+        }
+        runlog_page = runlog_next_page(runlog_page);
+        runlog_sequence++;
+        runlog_next_erased = 0;
+        header.event = RUNLOG_PAGE;
+        header.data = RUNLOG_VERSION;
+        header.delta = runlog_sequence;
+        header.motors = 0;
+        crc = runlog_header_crc(&header);
+        header.sensor[0] = (uint8_t)(crc >> 8);
+        header.sensor[1] = (uint8_t)crc;
+        header.sensor[2] = RUNLOG_MAGIC;
+        (void)FlashProgramBlock((uint16_t)&runlog_pages[runlog_page][0], (uint8_t *)&header, RUNLOG_RECORD_SIZE);
+        runlog_slot = 1;
+        return;
+    }
+    count = runlog_head - runlog_tail;
+    space = RUNLOG_PER_ROW - (runlog_slot & (RUNLOG_PER_ROW - 1));
+    if (count > space) {
+        count = space;
+    }
+    space = RUNLOG_BUFFER_RECORDS - (runlog_tail & (RUNLOG_BUFFER_RECORDS - 1));
+    if (count > space) {
+        count = space;                      // stop at end of RAM buffer
+    }
+    (void)FlashProgramBlock((uint16_t)&runlog_pages[runlog_page][runlog_slot], 
+                            (uint8_t *)&runlog_buffer[runlog_tail & (RUNLOG_BUFFER_RECORDS - 1)],
+                            count * RUNLOG_RECORD_SIZE);
+    runlog_slot += count;
+    runlog_tail += count;
+}
+
+//----------------------------------------------------------------------------
+// runlog_flush : write all buffered records
+// ============
+//
+// Notes
+//      Call with the robot stopped.
+//
+void runlog_flush(void) {
+
+    while (runlog_head != runlog_tail) {
+        if ((runlog_slot >= RUNLOG_PER_PAGE) && (runlog_next_erased == 0) && 
+            (state_of_vehicle != STOPPED)) {
+            return;
+        }
+        runlog_idle();
+    }
+}
+
+//----------------------------------------------------------------------------
+// runlog_dump : send the log on the serial port
+// ===========
+//
+// Description
+//      Pages are sent oldest first, one line per record :
+//
+//          page,ticks,event,data,left_motor,right_motor,front_L,front_C,front_R
+//
+//      "ticks" is the time since the start of the run.
+//
+void runlog_dump(void) {
+
+uint8_t   page, slot, i;
+uint16_t  ticks;
+volatile runlog_record_t  *record;
+
+    runlog_flush();
+    send_msg("page,ticks,event,data,left,right,front_L,front_C,front_R\r\n");
+    ticks = 0;
+    page = runlog_page;
+    for (i = 0 ; i < RUNLOG_NOS_PAGES ; i++) {
+        page = runlog_next_page(page);
+        if (runlog_header_valid(page) == 0) {
+            continue;
+        }
+        for (slot = 1 ; slot < RUNLOG_PER_PAGE ; slot++) {
+            record = &runlog_pages[page][slot];
+            if (record->event == RUNLOG_ERASED) {
+                break;
+            }
+            if (record->event == RUNLOG_RUN_START) {
+                ticks = 0;
+            } else {
+                ticks += record->delta;
+            }
+            send_u16(runlog_pages[page][0].delta);
+            send_msg(",");
+            send_u16(ticks);
+            send_msg(",");
+            send_u16(record->event);
+            send_msg(",");
+            send_u16(record->data);
+            send_msg(",");
+            send_u16(record->motors >> 4);
+            send_msg(",");
+            send_u16(record->motors & 0x0F);
+            send_msg(",");
+            send_u16(record->sensor[0]);
+            send_msg(",");
+            send_u16(record->sensor[1]);
+            send_msg(",");
+            send_u16(record->sensor[2]);
+            send_msg("\r\n");
+        }
+    }
+}
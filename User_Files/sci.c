@@ -6,63 +6,311 @@
 //
 // Common initialization of the write once registers
 //
+// Transmit is buffered : bytes are placed in a ring buffer which is emptied
+// by the SCI transmit interrupt (sci_tx_isr). A single binary frame (e.g.
+// telemetry) can be queued from an interrupt routine with sci_send_frame.
+// Receive is buffered : the SCI receive interrupt (sci_rx_isr) fills a ring
+// buffer and counts complete lines for sci_readline.
+//
 // Author                Date          Comment
 //----------------------------------------------------------------------------
 // Jim Herd            8/08/2008    
+// agent              19/10/2026      interrupt driven transmit ring buffer
+// agent              19/10/2026      interrupt driven receive and line input
 //----------------------------------------------------------------------------
  
 #include "global.h"
 
+char              sci_tx_buffer[SCI_TX_BUFFER_SIZE];
+volatile uint8_t  sci_tx_head;          // next free slot (written by sci_write)
+volatile uint8_t  sci_tx_tail;          // next byte to send (written by sci_tx_isr)
+uint16_t          sci_tx_dropped;       // bytes discarded by SCI_DROP writes
+
+uint8_t           sci_frame[SCI_FRAME_SIZE];
+volatile uint8_t  sci_frame_length;     // bytes in frame
+volatile uint8_t  sci_frame_index;      // next frame byte to send
+
+char              sci_rx_buffer[SCI_RX_BUFFER_SIZE];
+volatile uint8_t  sci_rx_head;          // next free slot (written by sci_rx_isr)
+volatile uint8_t  sci_rx_tail;          // next byte to read
+volatile uint8_t  sci_rx_lines;         // complete lines in buffer
+uint8_t           sci_rx_line_length;   // characters in line being received
+char              sci_rx_last;
+uint16_t          sci_rx_overruns;      // bytes lost in the SCI hardware
+uint16_t          sci_rx_framing_errors;
+uint16_t          sci_rx_overflows;     // bytes lost with receive buffer full
+
+//----------------------------------------------------------------------------
+// sci_write : queue bytes for transmission
+// =========
+//
+// Parameters
+//      data    : bytes to send
+//      length  : number of bytes
+//      policy  : SCI_DROP  - return when the buffer is full
+//                SCI_BLOCK - wait for space in the buffer
+//
+// Returns
+//      number of bytes accepted
+//
+// Notes
+//      Only sci_write moves the head and only sci_tx_isr moves the tail, so
+//      no interrupt masking is needed. The transmit interrupt is enabled
+//      after each byte is added; sci_tx_isr disables it when the buffer is
+//      empty. SCI_BLOCK must not be used from an interrupt routine.
+//
+uint8_t sci_write(const char *data, uint8_t length, sci_overflow_t policy) {
+
+uint8_t   count, next;
+
+    for (count = 0 ; count < length ; count++) {
+        next = (sci_tx_head + 1) & (SCI_TX_BUFFER_SIZE - 1);
+        if (next == sci_tx_tail) {
+            if (policy == SCI_DROP) {
+                sci_tx_dropped += (length - count);
+                break;
+            }
+            while (next == sci_tx_tail) {
+                ;                                   // wait for sci_tx_isr
+            }
+        }
+        sci_tx_buffer[sci_tx_head] = data[count];
+        sci_tx_head = next;
+        SCI1C2_TIE = 1;
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------------
+// sci_tx_space : free space in transmit buffer
+// ============
+//
+uint8_t sci_tx_space(void) {
+
+    return (uint8_t)((sci_tx_tail - sci_tx_head - 1) & (SCI_TX_BUFFER_SIZE - 1));
+}
+
+//----------------------------------------------------------------------------
+// sci_send_frame : queue a binary frame for transmission
+// ==============
+//
+// Parameters
+//      frame  : bytes to send
+//      length : number of bytes (max SCI_FRAME_SIZE)
+//
+// Returns
+//      1 if the frame was queued, 0 if the previous frame is still being sent
+//
+// Notes
+//      For use from interrupt routines (or with interrupts masked). Once
+//      started a frame is sent ahead of the ring buffer so that it is not
+//      split up.
+//
+uint8_t sci_send_frame(const uint8_t *frame, uint8_t length) {
+
+uint8_t   i;
+
+    if ((sci_frame_index < sci_frame_length) || (length > SCI_FRAME_SIZE)) {
+        return 0;
+    }
+    for (i = 0 ; i < length ; i++) {
+        sci_frame[i] = frame[i];
+    }
+    sci_frame_index = 0;
+    sci_frame_length = length;
+    SCI1C2_TIE = 1;
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// sci_flush : wait for all queued bytes to be sent
+// =========
+//
+// Notes
+//      Returns when the last stop bit has left the transmitter.
+//
+void sci_flush(void) {
+
+    while ((sci_tx_head != sci_tx_tail) || (sci_frame_index < sci_frame_length)) {
+        ;
+    }
+    while (!SCI1S1_TC) {
+        ;
+    }
+}
+
+//----------------------------------------------------------------------------
+// sci_tx_isr : send next byte from the transmit buffer
+// ==========
+//
+// Notes
+//      Called from the SCI transmit interrupt when TDRE is set. Reading
+//      SCI1S1 then writing SCI1D clears TDRE.
+//
+void sci_tx_isr(void) {
+
+    if (sci_frame_index < sci_frame_length) {
+        (void)SCI1S1;
+        SCI1D = sci_frame[sci_frame_index++];
+        return;
+    }
+    if (sci_tx_head == sci_tx_tail) {
+        SCI1C2_TIE = 0;                     // nothing left to send
+        return;
+    }
+    (void)SCI1S1;
+    SCI1D = sci_tx_buffer[sci_tx_tail];
+    sci_tx_tail = (sci_tx_tail + 1) & (SCI_TX_BUFFER_SIZE - 1);
+}
+
 //***********************************************************************
 //** Function:      sci_tx_byte
-//** Description:   SCI Tx function
-//** Parameters:    None
+//** Description:   SCI Tx function, waits if the transmit buffer is full
+//** Parameters:    s_char - byte to send
 //** Returns:       None
 //*********************************************************************** 
 void sci_tx_byte(char s_char){
-char dummy;
-
-    SCI1C2_TE = 1;          	// enable Tx
-    dummy = SCI1S1;          	// 1st half of TDRE clear procedure
-    SCI1D = s_char;             // 2nd half of TDRE clear procedure
-    while(!SCI1S1_TDRE)
-        ;			            // Wait until send buffer empty
-    while(!SCI1S1_TC)
-        ;       	            // Wait until byte sent
-    SCI1C2_TE = 0;
+
+    (void)sci_write(&s_char, 1, SCI_BLOCK);
+}
+
+//----------------------------------------------------------------------------
+// sci_rx_isr : store received byte and count complete lines
+// ==========
+//
+// Notes
+//      Called from the SCI receive interrupt. Reading SCI1S1 then SCI1D
+//      clears RDRF and the error flags. Bytes with a framing error are
+//      discarded. CR, LF and CR-LF all end a line and are stored as a
+//      single '\n'. A line reaching SCI_LINE_SIZE-1 characters is counted
+//      as complete so that sci_readline always sees a line end.
+//
+void sci_rx_isr(void) {
+
+uint8_t   status, next;
+char      ch;
+
+    status = SCI1S1;
+    ch = SCI1D;
+    if (status & SCI1S1_OR_MASK) {
+        sci_rx_overruns++;
+    }
+    if (status & SCI1S1_FE_MASK) {
+        sci_rx_framing_errors++;
+        return;
+    }
+    if ((ch == '\n') && (sci_rx_last == '\r')) {
+        sci_rx_last = ch;                   // second half of CR-LF
+        return;
+    }
+    sci_rx_last = ch;
+    if (ch == '\r') {
+        ch = '\n';
+    }
+    next = (sci_rx_head + 1) & (SCI_RX_BUFFER_SIZE - 1);
+    if (next == sci_rx_tail) {
+        sci_rx_overflows++;                 // buffer full
+        return;
+    }
+    sci_rx_buffer[sci_rx_head] = ch;
+    sci_rx_head = next;
+    if ((ch == '\n') || (++sci_rx_line_length >= (SCI_LINE_SIZE - 1))) {
+        sci_rx_line_length = 0;
+        sci_rx_lines++;
+    }
+}
+
+//----------------------------------------------------------------------------
+// sci_readline : get a complete line from the receive buffer
+// ============
+//
+// Parameters
+//      line : buffer for the line
+//      size : size of buffer (including terminating NUL)
+//
+// Returns
+//      length of line (line end removed) or SCI_NO_LINE if no complete
+//      line has been received
+//
+// Notes
+//      Does not wait. Characters beyond size-1 are discarded.
+//
+uint8_t sci_readline(char line[], uint8_t size) {
+
+uint8_t   length, count;
+char      ch;
+
+    if (sci_rx_lines == 0) {
+        return SCI_NO_LINE;
+    }
+    length = 0;
+    for (count = 0 ; count < (SCI_LINE_SIZE - 1) ; count++) {
+        if (sci_rx_tail == sci_rx_head) {
+            break;
+        }
+        ch = sci_rx_buffer[sci_rx_tail];
+        sci_rx_tail = (sci_rx_tail + 1) & (SCI_RX_BUFFER_SIZE - 1);
+        if (ch == '\n') {
+            break;
+        }
+        if (length < (size - 1)) {
+            line[length++] = ch;
+        }
+    }
+    line[length] = '\0';
+    DISABLE_INTERRUPTS;
+    sci_rx_lines--;
+    ENABLE_INTERRUPTS;
+    return length;
+}
+
+//----------------------------------------------------------------------------
+// sci_rx_ready : check for received bytes
+// ============
+//
+// Returns
+//      number of bytes waiting in the receive buffer
+//
+uint8_t sci_rx_ready(void) {
+
+    return (uint8_t)((sci_rx_head - sci_rx_tail) & (SCI_RX_BUFFER_SIZE - 1));
 }
 
 //***********************************************************************
 //** Function:      sci_rx_byte
-//** Description:   SCI Rx function
+//** Description:   SCI Rx function, waits for a byte from the receive buffer
 //** Parameters:    None
-//** Returns:       None
+//** Returns:       received byte (CR is returned as '\n')
+//** Notes:         Do not mix with sci_readline on the same input.
 //***********************************************************************
 char sci_rx_byte()
 {
 char rec_char;
 
-    SCI1C2_RE = 1;           	// enable Rx
-    while(!SCI1S1_RDRF)         
+    while (sci_rx_tail == sci_rx_head)
         ;                       // wait for character
-    rec_char = SCI1D;        	// get received character
-    SCI1C2_RE = 0;              // disable Rx
+    rec_char = sci_rx_buffer[sci_rx_tail];
+    sci_rx_tail = (sci_rx_tail + 1) & (SCI_RX_BUFFER_SIZE - 1);
+    if ((rec_char == '\n') && (sci_rx_lines != 0)) {
+        DISABLE_INTERRUPTS;
+        sci_rx_lines--;
+        ENABLE_INTERRUPTS;
+    }
     return rec_char;			 			
 }
 
 //***********************************************************************
 //** Function:      send_msg
-//** Description:   SCI String Sender
-//** Parameters:    None
+//** Description:   SCI String Sender, waits if the transmit buffer is full
+//** Parameters:    msg - null terminated string
 //** Returns:       None
 //*********************************************************************** 
 void send_msg(char *msg){
-byte n=0;	   							// String pointer
-  
-    do{
-        sci_tx_byte(msg[n]);
-  	    n++;
-    }while(msg[n]);
+
+    while (*msg != '\0') {
+        (void)sci_write(msg, 1, SCI_BLOCK);
+        msg++;
+    }
 }
 
 //***********************************************************************
@@ -131,21 +379,28 @@ void * bcd(char byte, char number_str[])
 //
 // Description
 //		Read an ASCII string via the USB virtual COM port.  String will be terminated
-//		with a carriage return character and be less that 32 characters in length.
+//		with a carriage return or newline character and be less than SCI_LINE_SIZE
+//		characters in length.
 //
-// Notes
+// Parameters
+//      string : buffer of at least SCI_LINE_SIZE characters
+//
+// Returns
+//      length of string (line end removed) or SCI_NO_LINE if no line is
+//      received within SCI_READ_TIMEOUT_MS
 //
 uint8_t read_string(char string[])
 {
-	uint8_t   i;
+	uint16_t  ms;
+	uint8_t   length;
 	
-	for(i=0 ; i < 32 ; i++){
-		if ((string[i] = sci_rx_byte()) == '\n') {
-			string[i+1] = '\0';
-			return i;
+	for (ms = 0 ; ms < SCI_READ_TIMEOUT_MS ; ms++) {
+		length = sci_readline(string, SCI_LINE_SIZE);
+		if (length != SCI_NO_LINE) {
+			return length;
 		}
+		DelayMs(1);
 	}
+	string[0] = '\0';
+	return SCI_NO_LINE;
 }
-
-
-    
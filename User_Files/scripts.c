@@ -42,3 +42,17 @@ const char script1[] =
 50 text \"end\"\n\
 90 end\n";
 
+#pragma INTO_ROM
+const char script2[] =
+"10 speed 50 50\n\
+20 for i = 1 to 4\n\
+30 motors 1 1\n\
+40 wait 10\n\
+50 motors 1 2\n\
+60 wait 4\n\
+70 next i\n\
+80 motors 0 0\n\
+90 sense 12 b\n\
+100 if b > 128 then goto 120\n\
+110 goto 90\n\
+120 end\n";
@@ -0,0 +1,403 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// shell.c : line based command shell on the serial port
+// =======
+//
+// Description
+//      Lines assembled by the SCI receive interrupt are split into words
+//      and the first word is looked up in "shell_commands". Each command
+//      replies with "OK" or "ERR <reason>" so that a test rig can drive the
+//      robot from a script, e.g.
+//
+//          move d 100 50 50        queue a 100 count move at 50%
+//          read 8                  read front left sensor
+//          telem 2                 start telemetry at 62.5Hz
+//          stop
+//
+//      shell_poll does not wait, and is called from the mode menu loop
+//      and between sequence instructions. Commands return at once apart
+//      from "mode" and "seq start", which run until the mode or sequence
+//      ends. While they run only commands marked SHELL_ANY_TIME are
+//      accepted.
+//
+// Notes
+//      Type "help" for the command list.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+static uint8_t cmd_help(uint8_t argc, char *argv[]);
+static uint8_t cmd_speed(uint8_t argc, char *argv[]);
+static uint8_t cmd_drive(uint8_t argc, char *argv[]);
+static uint8_t cmd_wheel(uint8_t argc, char *argv[]);
+static uint8_t cmd_move(uint8_t argc, char *argv[]);
+static uint8_t cmd_stop(uint8_t argc, char *argv[]);
+static uint8_t cmd_mode(uint8_t argc, char *argv[]);
+static uint8_t cmd_seq(uint8_t argc, char *argv[]);
+static uint8_t cmd_read(uint8_t argc, char *argv[]);
+static uint8_t cmd_thresh(uint8_t argc, char *argv[]);
+static uint8_t cmd_telem(uint8_t argc, char *argv[]);
+static uint8_t cmd_log(uint8_t argc, char *argv[]);
+
+const shell_command_t  shell_commands[] = {
+//    name       handler      args  flags             help
+    { "help",    cmd_help,    0,    SHELL_ANY_TIME,   "list commands" },
+    { "speed",   cmd_speed,   2,    SHELL_ANY_TIME,   "L R : mode speeds 0->100%" },
+    { "drive",   cmd_drive,   2,    SHELL_ANY_TIME,   "L R : motor PWM -100->100%" },
+    { "wheel",   cmd_wheel,   2,    SHELL_ANY_TIME,   "L R : closed loop mm/S" },
+    { "move",    cmd_move,    4,    SHELL_ANY_TIME,   "t|d|a N L R : queue move (ticks, counts, degrees)" },
+    { "stop",    cmd_stop,    0,    SHELL_ANY_TIME,   "stop motors, moves and sequence" },
+    { "mode",    cmd_mode,    1,    0,                "N : run system mode" },
+    { "seq",     cmd_seq,     1,    SHELL_ANY_TIME,   "start|stop : RAM sequence" },
+    { "read",    cmd_read,    1,    SHELL_ANY_TIME,   "N : a/d channel 0->13, pose 20->22" },
+    { "thresh",  cmd_thresh,  2,    0,                "L R : save wheel sensor thresholds" },
+    { "telem",   cmd_telem,   1,    SHELL_ANY_TIME,   "N : telemetry every N ticks, 0 = off" },
+    { "log",     cmd_log,     0,    0,                "dump run log as CSV" },
+};
+
+#define     NOS_SHELL_COMMANDS      (sizeof(shell_commands) / sizeof(shell_command_t))
+
+char        shell_line[SCI_LINE_SIZE];
+uint8_t     shell_depth;                    // > 0 while a command is running
+
+//----------------------------------------------------------------------------
+// shell_number : convert a decimal word to a number
+// ============
+//
+// Parameters
+//      text  : word with optional leading '-'
+//      value : result
+//
+// Returns
+//      1 if valid, 0 otherwise
+//
+static uint8_t shell_number(const char *text, int16_t *value) {
+
+int16_t   result;
+uint8_t   negative;
+
+    negative = 0;
+    if (*text == '-') {
+        negative = 1;
+        text++;
+    }
+    if (*text == '\0') {
+        return 0;
+    }
+    result = 0;
+    while (*text != '\0') {
+        if ((*text < '0') || (*text > '9') || (result > 3276)) {
+            return 0;
+        }
+        result = (result * 10) + (*text - '0');
+        text++;
+    }
+    *value = negative ? -result : result;
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// shell_numbers : convert command arguments to numbers
+// =============
+//
+// Parameters
+//      argv   : words, argv[1] onwards are converted
+//      count  : number of arguments
+//      values : results
+//      limit  : largest allowed magnitude
+//
+// Returns
+//      1 if all are valid, 0 otherwise
+//
+static uint8_t shell_numbers(char *argv[], uint8_t count, int16_t values[], int16_t limit) {
+
+uint8_t   i;
+
+    for (i = 0 ; i < count ; i++) {
+        if (shell_number(argv[i + 1], &values[i]) == 0) {
+            return 0;
+        }
+        if ((values[i] > limit) || (values[i] < -limit)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+//----------------------------------------------------------------------------
+// shell_split : split a line into words
+// ===========
+//
+// Returns
+//      number of words (up to SHELL_MAX_ARGS)
+//
+static uint8_t shell_split(char *line, char *argv[]) {
+
+uint8_t   argc;
+
+    argc = 0;
+    FOREVER {
+        while (*line == ' ') {
+            *line++ = '\0';
+        }
+        if ((*line == '\0') || (argc >= SHELL_MAX_ARGS)) {
+            break;
+        }
+        argv[argc++] = line;
+        while ((*line != ' ') && (*line != '\0')) {
+            line++;
+        }
+    }
+    return argc;
+}
+
+//----------------------------------------------------------------------------
+// shell_poll : run a received command line
+// ==========
+//
+// Notes
+//      Returns at once if no complete line has been received.
+//
+void shell_poll(void) {
+
+char      *argv[SHELL_MAX_ARGS];
+uint8_t   argc, i, result;
+const shell_command_t  *cmd;
+
+    if (sci_readline(shell_line, SCI_LINE_SIZE) == SCI_NO_LINE) {
+        return;
+    }
+    argc = shell_split(shell_line, argv);
+    if (argc == 0) {
+        return;
+    }
+    for (i = 0 ; i < NOS_SHELL_COMMANDS ; i++) {
+        if (strcmp(argv[0], shell_commands[i].name) == 0) {
+            break;
+        }
+    }
+    if (i == NOS_SHELL_COMMANDS) {
+        send_msg("ERR unknown\r\n");
+        return;
+    }
+    cmd = &shell_commands[i];
+    if ((argc - 1) < cmd->min_args) {
+        result = SHELL_BAD_ARGS;
+    } else if (((cmd->flags & SHELL_ANY_TIME) == 0) && ((shell_depth != 0) || (sequence_running != 0))) {
+        result = SHELL_BUSY;
+    } else {
+        shell_depth++;
+        result = cmd->handler(argc, argv);
+        shell_depth--;
+    }
+    switch (result) {
+        case SHELL_OK :
+            send_msg("OK\r\n");
+            break;
+        case SHELL_BAD_ARGS :
+            send_msg("ERR args\r\n");
+            break;
+        case SHELL_BUSY :
+            send_msg("ERR busy\r\n");
+            break;
+        case SHELL_REPLIED :
+            break;
+        default :
+            send_msg("ERR failed\r\n");
+            break;
+    }
+}
+
+//----------------------------------------------------------------------------
+// Command handlers
+// ================
+//
+// Parameters
+//      argc : number of words including the command name
+//      argv : words
+//
+// Returns
+//      SHELL_OK, SHELL_BAD_ARGS, SHELL_BUSY, SHELL_FAILED or SHELL_REPLIED
+//
+static uint8_t cmd_help(uint8_t argc, char *argv[]) {
+
+uint8_t   i;
+
+    for (i = 0 ; i < NOS_SHELL_COMMANDS ; i++) {
+        send_msg((char *)shell_commands[i].name);
+        send_msg(" ");
+        send_msg((char *)shell_commands[i].help);
+        send_msg("\r\n");
+    }
+    return SHELL_OK;
+}
+
+static uint8_t cmd_speed(uint8_t argc, char *argv[]) {
+
+int16_t   value[2];
+
+    if ((shell_numbers(argv, 2, value, 100) == 0) || (value[0] < 0) || (value[1] < 0)) {
+        return SHELL_BAD_ARGS;
+    }
+    gLeft_Speed = value[0];
+    gRight_Speed = value[1];
+    return SHELL_OK;
+}
+
+static uint8_t cmd_drive(uint8_t argc, char *argv[]) {
+
+int16_t   value[2];
+
+    if (shell_numbers(argv, 2, value, 100) == 0) {
+        return SHELL_BAD_ARGS;
+    }
+    move_abort();
+    speed_control_off();
+    set_motors((value[0] < 0) ? MOTOR_BACKWARD : ((value[0] > 0) ? MOTOR_FORWARD : MOTOR_BRAKE), (uint8_t)abs16(value[0]),
+               (value[1] < 0) ? MOTOR_BACKWARD : ((value[1] > 0) ? MOTOR_FORWARD : MOTOR_BRAKE), (uint8_t)abs16(value[1]));
+    return SHELL_OK;
+}
+
+static uint8_t cmd_wheel(uint8_t argc, char *argv[]) {
+
+int16_t   value[2];
+
+    if (shell_numbers(argv, 2, value, 1000) == 0) {
+        return SHELL_BAD_ARGS;
+    }
+    move_abort();
+    set_wheel_speed(value[0], value[1]);
+    return SHELL_OK;
+}
+
+static uint8_t cmd_move(uint8_t argc, char *argv[]) {
+
+int16_t   value[3];
+uint8_t   queued;
+
+    if ((shell_numbers(&argv[1], 3, value, 3276) == 0) || (value[0] < 0) ||
+        (value[1] > 100) || (value[1] < -100) || (value[2] > 100) || (value[2] < -100)) {
+        return SHELL_BAD_ARGS;
+    }
+    switch (argv[1][0]) {
+        case 't' :
+            queued = move_queue_time((uint16_t)value[0], (int8_t)value[1], (int8_t)value[2]);
+            break;
+        case 'd' :
+            queued = move_queue_distance((uint16_t)value[0], 
+                        (abs16(value[1]) >= abs16(value[2])) ? LEFT_MOTOR : RIGHT_MOTOR,
+                        (int8_t)value[1], (int8_t)value[2]);
+            break;
+        case 'a' :
+            queued = move_queue_angle((uint16_t)value[0], (int8_t)value[1], (int8_t)value[2]);
+            break;
+        default :
+            return SHELL_BAD_ARGS;
+    }
+    return (queued != 0) ? SHELL_OK : SHELL_BUSY;
+}
+
+static uint8_t cmd_stop(uint8_t argc, char *argv[]) {
+
+    sequence_abort = 1;
+    vehicle_stop();
+    return SHELL_OK;
+}
+
+static uint8_t cmd_mode(uint8_t argc, char *argv[]) {
+
+int16_t   value;
+
+    if ((shell_number(argv[1], &value) == 0) || (value < FIRST_SYS_MODE) || (value > LAST_SYS_MODE)) {
+        return SHELL_BAD_ARGS;
+    }
+    send_msg("OK\r\n");
+    run_mode((sys_modes_t)value);
+    return SHELL_REPLIED;
+}
+
+static uint8_t cmd_seq(uint8_t argc, char *argv[]) {
+
+    if (strcmp(argv[1], "stop") == 0) {
+        sequence_abort = 1;
+        return SHELL_OK;
+    }
+    if (strcmp(argv[1], "start") != 0) {
+        return SHELL_BAD_ARGS;
+    }
+    if ((shell_depth > 1) || (sequence_running != 0)) {
+        return SHELL_BUSY;
+    }
+    send_msg("OK\r\n");
+    run_sequence(shared.RAM_sequence.uint16);
+    return SHELL_REPLIED;
+}
+
+static uint8_t cmd_read(uint8_t argc, char *argv[]) {
+
+int16_t   channel, value;
+
+    if (shell_number(argv[1], &channel) == 0) {
+        return SHELL_BAD_ARGS;
+    }
+    switch (channel) {
+        case POSE_X_CHAN :
+            value = pose_x_cm();
+            break;
+        case POSE_Y_CHAN :
+            value = pose_y_cm();
+            break;
+        case POSE_HEADING_CHAN :
+            value = (int16_t)pose_heading_deg();
+            break;
+        default :
+            if ((channel < 0) || (channel >= NOS_ADC_CHANNELS)) {
+                return SHELL_BAD_ARGS;
+            }
+            value = get_adc((a2d_channels_t)channel);
+            break;
+    }
+    send_s16(channel);
+    send_msg("=");
+    send_s16(value);
+    send_msg("\r\n");
+    return SHELL_OK;
+}
+
+static uint8_t cmd_thresh(uint8_t argc, char *argv[]) {
+
+int16_t   value[2];
+
+    if ((shell_numbers(argv, 2, value, 255) == 0) || (value[0] < 0) || (value[1] < 0)) {
+        return SHELL_BAD_ARGS;
+    }
+    if ((move_done() == 0) || (state_of_vehicle != STOPPED)) {
+        return SHELL_BUSY;                  // flash jobs only run when stopped
+    }
+    if (save_wheel_thresholds((uint8_t)value[0], (uint8_t)value[1]) != KV_OK) {
+        return SHELL_FAILED;
+    }
+    return SHELL_OK;
+}
+
+static uint8_t cmd_telem(uint8_t argc, char *argv[]) {
+
+int16_t   value;
+
+    if ((shell_number(argv[1], &value) == 0) || (value < 0) || (value > 255)) {
+        return SHELL_BAD_ARGS;
+    }
+    telemetry_start((uint8_t)value);
+    return SHELL_OK;
+}
+
+static uint8_t cmd_log(uint8_t argc, char *argv[]) {
+
+    runlog_dump();
+    return SHELL_OK;
+}
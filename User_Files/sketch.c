@@ -64,6 +64,7 @@ uint8_t   activity;
 // 
         show_dual_chars(SKETCH_MODE_CODE, ('0'+ activity), 0);
         push_LED_display();       
+        runlog_start(RUNLOG_ID(SKETCH_MODE, activity));
         switch (activity) {
                 case SKETCH_MODE_0 :                          // in progress
                     run_sketch_mode_0();
@@ -77,6 +78,7 @@ uint8_t   activity;
                 default :
                     break;
         }
+        runlog_stop();
         show_dual_chars(SKETCH_MODE_CODE, ('0'+ activity), (A_TO_FLASH | 10));
         pop_LED_display();       
     } 
@@ -177,14 +179,13 @@ uint16_t      time, spiral_update_time;
 //
 // randomly decide on left or right spiral
 //        
+        bump_watch_start(ADC_CHANNEL_BIT(FRONT_SENSOR_C), SENSE_LOW);
         if (get_random_bit() == 1) {
             spiral_mode = LEFT_SPIRAL;
-             set_motor(LEFT_MOTOR, MOTOR_BACKWARD, MAX_SPIRAL_SPEED);
-             set_motor(RIGHT_MOTOR, MOTOR_FORWARD, MAX_SPIRAL_SPEED);        
+             set_motors(MOTOR_BACKWARD, MAX_SPIRAL_SPEED, MOTOR_FORWARD, MAX_SPIRAL_SPEED);
         } else {
             spiral_mode = RIGHT_SPIRAL;
-            set_motor(LEFT_MOTOR, MOTOR_FORWARD, MAX_SPIRAL_SPEED);
-            set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, MAX_SPIRAL_SPEED);
+            set_motors(MOTOR_FORWARD, MAX_SPIRAL_SPEED, MOTOR_BACKWARD, MAX_SPIRAL_SPEED);
         }
 //
 // run spiral code
@@ -196,8 +197,9 @@ uint16_t      time, spiral_update_time;
                 set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, i);
             }
             DelayMs(spiral_update_time);
-            if (get_adc(FRONT_SENSOR_C) < SENSE_LOW ) {       // check for bump
+            if (bump_watch_events() != 0) {                   // check for bump
                 vehicle_stop ();
+                bump_watch_stop();
                 return 0;
             }
         }        
@@ -208,12 +210,14 @@ uint16_t      time, spiral_update_time;
                 set_motor(RIGHT_MOTOR, MOTOR_FORWARD, i);
             }
             DelayMs(spiral_update_time);
-            if (get_adc(FRONT_SENSOR_C) < SENSE_LOW ) {        // check for bump
+            if (bump_watch_events() != 0) {                    // check for bump
                 vehicle_stop ();
+                bump_watch_stop();
                 return 0;
             } 
         }
         vehicle_stop ();
+        bump_watch_stop();
         return 0;
     }
 }
@@ -322,13 +326,11 @@ mode_state_t    state;
 //  produce pattern as sequence of line draws and turns
 //
     for (i = 0; i <= NOS_PATTTERN_LINES ; i++ ) {
-        set_motor(LEFT_MOTOR, MOTOR_FORWARD, SPIROGRAPH_SPEED);
-        set_motor(RIGHT_MOTOR, MOTOR_FORWARD, SPIROGRAPH_SPEED);
+        set_motors(MOTOR_FORWARD, SPIROGRAPH_SPEED, MOTOR_FORWARD, SPIROGRAPH_SPEED);
         DelayMs(line_draw_time * 50);
         vehicle_stop();
         DelayMs(10);
-        set_motor(LEFT_MOTOR, MOTOR_FORWARD, SPIROGRAPH_SPEED);
-        set_motor(RIGHT_MOTOR, MOTOR_BACKWARD, SPIROGRAPH_SPEED);
+        set_motors(MOTOR_FORWARD, SPIROGRAPH_SPEED, MOTOR_BACKWARD, SPIROGRAPH_SPEED);
         DelayMs(turn_time * 25);
         vehicle_stop();
         DelayMs(10); 
@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// speed_control.c : closed loop wheel speed control
+// ===============
+//
+// Description
+//      Each wheel has a fixed point PID controller run every PID_PERIOD
+//      ticks from the RTI. The measured speed comes from the encoder edge
+//      times (wheel_speed.c). The output is
+//
+//          PWM% = Kff.target + Kp.error + Ki.sum(error) + Kd.delta(error)
+//
+//      clamped to 0->100%. The integral is not updated while the output
+//      is saturated in the direction of the error (anti-windup) and is
+//      limited to +/-PID_I_LIMIT.
+//
+//      When both wheels have the same target speed (straight line or spin
+//      on the spot) the difference in encoder counts since the control
+//      started, or since the direction or left/right ratio of the targets
+//      last changed, is fed back as a cross coupling term, slowing the
+//      wheel that is ahead and speeding up the one behind. This corrects
+//      the heading error left by two independent speed loops. A change of
+//      magnitude only (e.g. a speed profile ramp) keeps the reference.
+//
+//      Gains can be tuned with the model in Host_Files/pid_sim.c, which
+//      compiles this file with HOST_SIM defined.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      replaces unused update_PID
+//----------------------------------------------------------------------------
+
+#ifdef HOST_SIM
+#include "speed_control.h"
+#else
+#include "global.h"
+#endif
+
+//----------------------------------------------------------------------------
+// wheel_pid_reset : clear controller state
+// ===============
+//
+void wheel_pid_reset(wheel_pid_t *pid) {
+
+    pid->i_term = 0;
+    pid->last_error = 0;
+}
+
+//----------------------------------------------------------------------------
+// wheel_pid_step : run one controller update
+// ==============
+//
+// Parameters
+//      pid    : controller state
+//      target : wanted speed (mm/S)
+//      error  : target - measured speed (mm/S) including cross coupling
+//
+// Returns
+//      PWM setting, 0% to 100%
+//
+uint8_t wheel_pid_step(wheel_pid_t *pid, uint16_t target, int16_t error) {
+
+int32_t   out, i_term;
+
+    out = ((int32_t)PID_KFF * target) 
+        + ((int32_t)PID_KP * error) 
+        + ((int32_t)PID_KD * (error - pid->last_error)) 
+        + pid->i_term;
+    pid->last_error = error;
+    //
+    // integrate unless output is already saturated in direction of error
+    //
+    if (!(((out >= PID_OUT_MAX) && (error > 0)) || ((out <= 0) && (error < 0)))) {
+        i_term = pid->i_term + ((int32_t)PID_KI * error);
+        if (i_term > PID_I_LIMIT) {
+            i_term = PID_I_LIMIT;
+        } else if (i_term < -PID_I_LIMIT) {
+            i_term = -PID_I_LIMIT;
+        }
+        pid->i_term = (int16_t)i_term;
+    }
+    if (out > PID_OUT_MAX) {
+        out = PID_OUT_MAX;
+    } else if (out < 0) {
+        out = 0;
+    }
+    return (uint8_t)((out + 128) >> 8);
+}
+
+#ifndef HOST_SIM
+
+wheel_pid_t     wheel_pid[2];
+int16_t         target_speed[2];            // mm/S, negative = backward
+uint16_t        start_count[2];             // encoder counts when targets set
+uint8_t         speed_control_on;
+uint8_t         speed_control_countdown;
+
+//----------------------------------------------------------------------------
+// set_wheel_speed : set closed loop speed targets
+// ===============
+//
+// Parameters
+//      left, right : wheel speeds in mm/S (negative = backward)
+//
+// Notes
+//      Setting both speeds to 0 brakes the motors and stops the control.
+//      Motor direction is taken from the sign of the target as the
+//      encoders cannot detect direction.
+//
+void set_wheel_speed(int16_t left, int16_t right) {
+
+    DISABLE_INTERRUPTS;
+    set_wheel_targets(left, right);
+    ENABLE_INTERRUPTS;
+}
+
+//----------------------------------------------------------------------------
+// set_wheel_targets : set closed loop speed targets from an interrupt routine
+// =================
+//
+// Notes
+//      As set_wheel_speed but does not change the interrupt mask.
+//      The cross coupling reference counts are only taken again when
+//      the control starts, a wheel changes direction or the ratio of
+//      left to right speed changes, so that a profile can call this
+//      every update without losing the heading correction.
+//
+void set_wheel_targets(int16_t left, int16_t right) {
+
+uint8_t   new_reference;
+
+    if ((left == 0) && (right == 0)) {
+        speed_control_on = 0;
+        target_speed[LEFT_MOTOR] = 0;
+        target_speed[RIGHT_MOTOR] = 0;
+        set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
+        return;
+    }
+    if ((left ^ target_speed[LEFT_MOTOR]) < 0) {        // change of direction
+        wheel_pid_reset(&wheel_pid[LEFT_MOTOR]);
+    }
+    if ((right ^ target_speed[RIGHT_MOTOR]) < 0) {
+        wheel_pid_reset(&wheel_pid[RIGHT_MOTOR]);
+    }
+    if (speed_control_on == 0) {
+        wheel_pid_reset(&wheel_pid[LEFT_MOTOR]);
+        wheel_pid_reset(&wheel_pid[RIGHT_MOTOR]);
+        speed_control_countdown = 1;                    // start on next tick
+    }
+    new_reference = (speed_control_on == 0)
+                 || ((left ^ target_speed[LEFT_MOTOR]) < 0)
+                 || ((right ^ target_speed[RIGHT_MOTOR]) < 0)
+                 || (((int32_t)left * target_speed[RIGHT_MOTOR]) != ((int32_t)right * target_speed[LEFT_MOTOR]));
+    target_speed[LEFT_MOTOR] = left;
+    target_speed[RIGHT_MOTOR] = right;
+    if (new_reference) {
+        start_count[LEFT_MOTOR] = wheel_speed[LEFT_MOTOR].count;
+        start_count[RIGHT_MOTOR] = wheel_speed[RIGHT_MOTOR].count;
+    }
+    speed_control_on = 1;
+}
+
+//----------------------------------------------------------------------------
+// speed_control_off : stop closed loop control
+// =================
+//
+// Notes
+//      Motors are left as they are. Called by vehicle_stop.
+//
+void speed_control_off(void) {
+
+    DISABLE_INTERRUPTS;
+    speed_control_on = 0;
+    target_speed[LEFT_MOTOR] = 0;
+    target_speed[RIGHT_MOTOR] = 0;
+    ENABLE_INTERRUPTS;
+}
+
+//----------------------------------------------------------------------------
+// speed_control_task : update wheel speed controllers
+// ==================
+//
+// Notes
+//      Run from the RTI every tick, updates every PID_PERIOD ticks.
+//
+void speed_control_task(void) {
+
+uint8_t    wheel;
+int16_t    cross;
+int16_t    error[2];
+uint16_t   target[2];
+uint8_t    pwm[2];
+motor_state_t  state[2];
+
+    if (speed_control_on == 0) {
+        return;
+    }
+    if (--speed_control_countdown != 0) {
+        return;
+    }
+    speed_control_countdown = PID_PERIOD;
+    for (wheel = LEFT_MOTOR ; wheel <= RIGHT_MOTOR ; wheel++) {
+        target[wheel] = (uint16_t)abs16(target_speed[wheel]);
+        error[wheel] = (int16_t)target[wheel] - (int16_t)wheel_speed[wheel].speed;
+    }
+    //
+    // cross coupling when both wheels should travel the same distance
+    //
+    if (target[LEFT_MOTOR] == target[RIGHT_MOTOR]) {
+        cross = (int16_t)(wheel_speed[LEFT_MOTOR].count - start_count[LEFT_MOTOR])
+              - (int16_t)(wheel_speed[RIGHT_MOTOR].count - start_count[RIGHT_MOTOR]);
+        if (cross > PID_CROSS_LIMIT) {
+            cross = PID_CROSS_LIMIT;
+        } else if (cross < -PID_CROSS_LIMIT) {
+            cross = -PID_CROSS_LIMIT;
+        }
+        error[LEFT_MOTOR] -= (PID_KC * cross);
+        error[RIGHT_MOTOR] += (PID_KC * cross);
+    }
+    for (wheel = LEFT_MOTOR ; wheel <= RIGHT_MOTOR ; wheel++) {
+        pwm[wheel] = wheel_pid_step(&wheel_pid[wheel], target[wheel], error[wheel]);
+        if (target_speed[wheel] == 0) {
+            state[wheel] = MOTOR_BRAKE;
+        } else if (target_speed[wheel] > 0) {
+            state[wheel] = MOTOR_FORWARD;
+        } else {
+            state[wheel] = MOTOR_BACKWARD;
+        }
+    }
+    set_motors(state[LEFT_MOTOR], pwm[LEFT_MOTOR], state[RIGHT_MOTOR], pwm[RIGHT_MOTOR]);
+}
+
+#endif /* HOST_SIM */
@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// telemetry.c : binary snapshots of robot state sent in the background
+// ===========
+//
+// Description
+//      Every "period" RTI ticks a snapshot of the a/d channels, wheel
+//      counts and speeds, motor settings, switches and tick_count_16 is
+//      packed into a 30 byte record (layout in telemetry.h), followed by a
+//      CRC-16. The record is COBS encoded so that it contains no 0x00
+//      bytes, and a 0x00 delimiter is added at each end. The frame is then
+//      handed to the SCI transmit interrupt (sci_send_frame).
+//
+//      A period of 2 ticks gives 62.5 frames per second, about 2200 bytes
+//      per second or 40% of the link at 57600 baud.
+//
+//      If the previous frame has not finished sending the new one is
+//      dropped and counted.
+//
+// Notes
+//      Text sent while telemetry runs lands between frames and is
+//      rejected by the decoder's CRC check (Host_Files/telemetry_decode.c).
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      initial design
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+uint8_t     telemetry_rate;                 // ticks between frames, 0 = off
+uint8_t     telemetry_countdown;
+uint8_t     telemetry_sequence;
+uint16_t    telemetry_frames_sent, telemetry_frames_dropped;
+uint8_t     telemetry_raw[TELEMETRY_RAW_SIZE];
+uint8_t     telemetry_frame[TELEMETRY_FRAME_SIZE];
+
+//----------------------------------------------------------------------------
+// telemetry_start : start sending snapshots
+// ===============
+//
+// Parameters
+//      period : 8mS ticks between snapshots (1 -> 255), 0 = stop
+//
+void telemetry_start(uint8_t period) {
+
+    DISABLE_INTERRUPTS;
+    telemetry_rate = period;
+    telemetry_countdown = period;
+    telemetry_frames_sent = 0;
+    telemetry_frames_dropped = 0;
+    ENABLE_INTERRUPTS;
+}
+
+//----------------------------------------------------------------------------
+// telemetry_stop : stop sending snapshots
+// ==============
+//
+void telemetry_stop(void) {
+
+    telemetry_rate = 0;
+}
+
+//----------------------------------------------------------------------------
+// telemetry_period : get current snapshot period
+// ================
+//
+uint8_t telemetry_period(void) {
+
+    return telemetry_rate;
+}
+
+//----------------------------------------------------------------------------
+// cobs_encode : Consistent Overhead Byte Stuffing
+// ===========
+//
+// Parameters
+//      in     : bytes to encode
+//      length : number of bytes (max 254)
+//      out    : encoded bytes, length + 1
+//
+// Returns
+//      number of encoded bytes
+//
+// Notes
+//      Each 0x00 is replaced by the distance to the next 0x00 (or the end)
+//      so the output holds no 0x00 bytes.
+//
+uint8_t cobs_encode(const uint8_t *in, uint8_t length, uint8_t *out) {
+
+uint8_t   code_index, out_index, code, i;
+
+    code_index = 0;
+    out_index = 1;
+    code = 1;
+    for (i = 0 ; i < length ; i++) {
+        if (in[i] == 0) {
+            out[code_index] = code;
+            code_index = out_index++;
+            code = 1;
+        } else {
+            out[out_index++] = in[i];
+            code++;
+        }
+    }
+    out[code_index] = code;
+    return out_index;
+}
+
+//----------------------------------------------------------------------------
+// put_16 : store 16-bit value little endian
+// ======
+//
+static void put_16(uint8_t *buffer, uint16_t value) {
+
+    buffer[0] = (uint8_t)value;
+    buffer[1] = (uint8_t)(value >> 8);
+}
+
+//----------------------------------------------------------------------------
+// telemetry_task : send a snapshot when due
+// ==============
+//
+// Notes
+//      Run from the RTI every tick after the sensor, speed and switch tasks
+//      so the snapshot holds this tick's values.
+//
+void telemetry_task(void) {
+
+uint8_t   i, length;
+uint16_t  crc;
+
+    if (telemetry_rate == 0) {
+        return;
+    }
+    if (--telemetry_countdown != 0) {
+        return;
+    }
+    telemetry_countdown = telemetry_rate;
+    
+    telemetry_raw[TELEMETRY_TYPE] = TELEMETRY_SNAPSHOT;
+    telemetry_raw[TELEMETRY_SEQUENCE] = telemetry_sequence++;
+    put_16(&telemetry_raw[TELEMETRY_TICKS], tick_count_16);
+    for (i = 0 ; i < NOS_ADC_CHANNELS ; i++) {
+        telemetry_raw[TELEMETRY_ADC + i] = get_adc((a2d_channels_t)i);
+    }
+    put_16(&telemetry_raw[TELEMETRY_LEFT_COUNT], wheel_speed[LEFT_MOTOR].count);
+    put_16(&telemetry_raw[TELEMETRY_RIGHT_COUNT], wheel_speed[RIGHT_MOTOR].count);
+    put_16(&telemetry_raw[TELEMETRY_LEFT_SPEED], wheel_speed[LEFT_MOTOR].speed);
+    put_16(&telemetry_raw[TELEMETRY_RIGHT_SPEED], wheel_speed[RIGHT_MOTOR].speed);
+    telemetry_raw[TELEMETRY_MOTOR_STATES] = DRIVE_STATES(left_motor_state, right_motor_state);
+    telemetry_raw[TELEMETRY_LEFT_PWM] = left_motor_pwm;
+    telemetry_raw[TELEMETRY_RIGHT_PWM] = right_motor_pwm;
+    telemetry_raw[TELEMETRY_SWITCHES] = debounced_state;
+    crc = crc16_update(CRC16_INIT, telemetry_raw, TELEMETRY_PAYLOAD_SIZE);
+    put_16(&telemetry_raw[TELEMETRY_PAYLOAD_SIZE], crc);
+    
+    telemetry_frame[0] = 0x00;
+    length = cobs_encode(telemetry_raw, TELEMETRY_RAW_SIZE, &telemetry_frame[1]) + 1;
+    telemetry_frame[length++] = 0x00;
+    if (sci_send_frame(telemetry_frame, length) != 0) {
+        telemetry_frames_sent++;
+    } else {
+        telemetry_frames_dropped++;
+    }
+}
@@ -187,7 +187,7 @@ void tokenizer_next(void) {
 	return;
 }
 /*---------------------------------------------------------------------------*/
-uint8_t tokenizer_num(void) {
+int16_t tokenizer_num(void) {
 	return atoi(ptr);
 }
 /*---------------------------------------------------------------------------*/
@@ -73,6 +73,7 @@ void ubasic_init(const char *program)
 	for_stack_ptr = gosub_stack_ptr = 0;
 	tokenizer_init(program);
 	ended = 0;
+	reset_pose();
 }
 /*---------------------------------------------------------------------------*/
 static void accept(uint8_t token) 
@@ -550,7 +551,7 @@ static void speed_statement(void)
 //
 //  read  item  variable
 //
-enum SYSTEM_VALUES {NOW_TIME};
+enum SYSTEM_VALUES {NOW_TIME, POSE_X, POSE_Y, POSE_HEADING};
 
 static void read_statement(void) 
 {
@@ -568,6 +569,15 @@ static void read_statement(void)
 	case NOW_TIME :
 		value = tick_count_16;
 		break;
+	case POSE_X :
+		value = (uint16_t)pose_x_cm();
+		break;
+	case POSE_Y :
+		value = (uint16_t)pose_y_cm();
+		break;
+	case POSE_HEADING :
+		value = pose_heading_deg();
+		break;
 	default :
 		break;
 	}
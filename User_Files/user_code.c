@@ -81,11 +81,13 @@ void user_init(void) {
 
     disable_wheel_count();
     
-    switch_A = RELEASED; switch_B = RELEASED; switch_C = RELEASED; switch_D = RELEASED;
+    init_switches();
 
     state_of_vehicle = STOPPED;
     left_motor_state = MOTOR_OFF;
     right_motor_state = MOTOR_OFF;
+    left_motor_pwm = MOTOR_PWM_UNKNOWN;        // force first set_motors write
+    right_motor_pwm = MOTOR_PWM_UNKNOWN;
     
     gLeft_Speed  = DEFAULT_SPEED; 
     gRight_Speed = DEFAULT_SPEED; 
@@ -96,13 +98,17 @@ void user_init(void) {
     current_right_speed = 0; 
     pwm_differential = DIFFERENTIAL_NULL;
 
-    set_motor(RIGHT_MOTOR, MOTOR_OFF, 0);
-    set_motor(LEFT_MOTOR , MOTOR_OFF, 0);
+    set_motors(MOTOR_OFF, 0, MOTOR_OFF, 0);
     
     tick_count_8 = 0;
     tick_count_16 = 0;
     second_count = 0;
-    tick_for_second_count = TICKS_IN_ONE_SECOND;
+    init_tasks();
+//
+// check persistent data and load calibration constants into RAM
+//
+    persist_load();
+    runlog_init();
 //
 // set wheel sensor initial conditions
 //    
@@ -110,21 +116,20 @@ void user_init(void) {
     right_wheel_count = 0;
     
     left_wheel_sensor_value = get_adc(WHEEL_SENSOR_L);
-    if (left_wheel_sensor_value < FLASH_data.LEFT_WHEEL_THRESHOLD) {
+    if (left_wheel_sensor_value < left_wheel_threshold) {
         left_wheel_sensor_value = BLACK; 
     } else {
         left_wheel_sensor_value = WHITE;
     }
     
     right_wheel_sensor_value = get_adc(WHEEL_SENSOR_R);
-    if (right_wheel_sensor_value < FLASH_data.RIGHT_WHEEL_THRESHOLD) {
+    if (right_wheel_sensor_value < right_wheel_threshold) {
         right_wheel_sensor_value = BLACK; 
     } else {
         right_wheel_sensor_value = WHITE;
     }
           
-    left_speed_index = 0;     // index to left speed circular buffer
-    right_speed_index = 0;    // index to right speed circular buffer
+    init_wheel_speed();
     
     display_init();
 //
@@ -140,6 +145,10 @@ void user_init(void) {
 // enable system interrupts
 //
     EnableInterrupts;       /* enable interrupts */
+    reset_isr_stats();
+    reset_pose();
+    telemetry_start(TELEMETRY_DEFAULT_PERIOD);
+    persist_report();
     
     DelayMs(1000);
 //
@@ -204,47 +213,6 @@ void enable_wheel_count(void) {
     KBI1SC_KBIE = 1;    
 }
 
-//----------------------------------------------------------------------------
-// update_PID : compute controller output from PID parameters
-// ==========
-//
-// Parameters
-//      error : current calculated error
-//      old_error : previous calculated error
-//
-// Notes
-//      Care need to be taken
-//  
-//uint8_t  update_PID(int8_t error, int8_t old_error) {
-//
-// compute proportional term
-//
-//    P_term = P_gain * error;
-//
-// compute intergral term and check against limits
-//
-//    I_value = I_value + error;
-//    if (I_value > I_MAX) {
-//        I_value = I_max;
-//    } else {
-//        if (I_value < I_MIN) {
-//            I_value = I_MIN;
-//        } 
-//    }
-//    I_term = I_gain * I_value;
-//
-// compute derivative term
-//
-//    D_term = D_gain * (error - old_error);
-//
-// compute PID value
-//
-//    PID_value = P_term + I_term - D_term;
-//   PID_value = PID_value / 100;
-//        
-//    return (uint8_t)PID_value;    
-//}
-
 //----------------------------------------------------------------------------
 // set_vehicle_state : update state of vehicle
 // =================
@@ -274,13 +242,120 @@ void set_vehicle_state(void) {
     }
 }
 
+//----------------------------------------------------------------------------
+// PWM compare values for 0% to 100% speed
+//
+const uint16_t pwm_duty_table[101] = {
+    PWM_DUTY(0), PWM_DUTY(1), PWM_DUTY(2), PWM_DUTY(3), PWM_DUTY(4), PWM_DUTY(5), PWM_DUTY(6), PWM_DUTY(7),
+    PWM_DUTY(8), PWM_DUTY(9), PWM_DUTY(10), PWM_DUTY(11), PWM_DUTY(12), PWM_DUTY(13), PWM_DUTY(14), PWM_DUTY(15),
+    PWM_DUTY(16), PWM_DUTY(17), PWM_DUTY(18), PWM_DUTY(19), PWM_DUTY(20), PWM_DUTY(21), PWM_DUTY(22), PWM_DUTY(23),
+    PWM_DUTY(24), PWM_DUTY(25), PWM_DUTY(26), PWM_DUTY(27), PWM_DUTY(28), PWM_DUTY(29), PWM_DUTY(30), PWM_DUTY(31),
+    PWM_DUTY(32), PWM_DUTY(33), PWM_DUTY(34), PWM_DUTY(35), PWM_DUTY(36), PWM_DUTY(37), PWM_DUTY(38), PWM_DUTY(39),
+    PWM_DUTY(40), PWM_DUTY(41), PWM_DUTY(42), PWM_DUTY(43), PWM_DUTY(44), PWM_DUTY(45), PWM_DUTY(46), PWM_DUTY(47),
+    PWM_DUTY(48), PWM_DUTY(49), PWM_DUTY(50), PWM_DUTY(51), PWM_DUTY(52), PWM_DUTY(53), PWM_DUTY(54), PWM_DUTY(55),
+    PWM_DUTY(56), PWM_DUTY(57), PWM_DUTY(58), PWM_DUTY(59), PWM_DUTY(60), PWM_DUTY(61), PWM_DUTY(62), PWM_DUTY(63),
+    PWM_DUTY(64), PWM_DUTY(65), PWM_DUTY(66), PWM_DUTY(67), PWM_DUTY(68), PWM_DUTY(69), PWM_DUTY(70), PWM_DUTY(71),
+    PWM_DUTY(72), PWM_DUTY(73), PWM_DUTY(74), PWM_DUTY(75), PWM_DUTY(76), PWM_DUTY(77), PWM_DUTY(78), PWM_DUTY(79),
+    PWM_DUTY(80), PWM_DUTY(81), PWM_DUTY(82), PWM_DUTY(83), PWM_DUTY(84), PWM_DUTY(85), PWM_DUTY(86), PWM_DUTY(87),
+    PWM_DUTY(88), PWM_DUTY(89), PWM_DUTY(90), PWM_DUTY(91), PWM_DUTY(92), PWM_DUTY(93), PWM_DUTY(94), PWM_DUTY(95),
+    PWM_DUTY(96), PWM_DUTY(97), PWM_DUTY(98), PWM_DUTY(99), PWM_DUTY(100)
+};
+
+//----------------------------------------------------------------------------
+// set_motors : configure both motors
+// ==========
+//
+// Parameters
+//      left_state, right_state : MOTOR_OFF, MOTOR_FORWARD, MOTOR_BACKWARD, or MOTOR_BRAKE
+//      left_pct, right_pct     : 0% to 100%
+//
+// Notes
+//      The compare values come from pwm_duty_table and the four channel
+//      registers are written one after the other so both wheels change in
+//      the same PWM period. Nothing is written if neither motor setting has
+//      changed.
+//
+//      Called from the foreground and from the RTI (speed_control_task),
+//      so the compare and the register and state updates are done with
+//      interrupts masked. The mask is restored, not cleared, so this is
+//      safe in an interrupt routine.
+//
+void  set_motors(motor_state_t left_state, uint8_t left_pct, motor_state_t right_state, uint8_t right_pct) {
+
+uint16_t  c0_value, c1_value, c2_value, c3_value;
+uint8_t   ccr;
+
+    if ((left_state == MOTOR_OFF) || (left_state == MOTOR_BRAKE)) {
+        left_pct = 0;
+    } else if (left_pct > 100) {
+        left_pct = 100;
+    }
+    if ((right_state == MOTOR_OFF) || (right_state == MOTOR_BRAKE)) {
+        right_pct = 0;
+    } else if (right_pct > 100) {
+        right_pct = 100;
+    }
+    switch (left_state) {
+        case MOTOR_FORWARD :        // set pwm on LM_PWM1 and HIGH on LM_PWM2
+            c0_value = pwm_duty_table[left_pct];
+            c1_value = PWM_COUNT;
+            break;
+        case MOTOR_BACKWARD :       // set HIGH on LM_PWM1 and pwm on LM_PWM2
+            c0_value = PWM_COUNT;
+            c1_value = pwm_duty_table[left_pct];
+            break;
+        case MOTOR_BRAKE :          // set HIGH on LM_PWM1 and LM_PWM2
+            c0_value = PWM_COUNT;
+            c1_value = PWM_COUNT;
+            break;
+        case MOTOR_OFF :            // set LOW on LM_PWM1 and LM_PWM2 (FREEWHEEL)
+        default :
+            c0_value = 0;
+            c1_value = 0;
+            break;
+    }
+    switch (right_state) {
+        case MOTOR_FORWARD :        // set HIGH on RM_PWM1 and pwm on RM_PWM2
+            c2_value = PWM_COUNT;
+            c3_value = pwm_duty_table[right_pct];
+            break;
+        case MOTOR_BACKWARD :       // set pwm on RM_PWM1 and HIGH on RM_PWM2
+            c2_value = pwm_duty_table[right_pct];
+            c3_value = PWM_COUNT;
+            break;
+        case MOTOR_BRAKE :          // set HIGH on RM_PWM1 and RM_PWM2
+            c2_value = PWM_COUNT;
+            c3_value = PWM_COUNT;
+            break;
+        case MOTOR_OFF :            // set LOW on RM_PWM1 and RM_PWM2 (FREEWHEEL)
+        default :
+            c2_value = 0;
+            c3_value = 0;
+            break;
+    }
+    SAVE_INTERRUPTS(ccr);
+    if ((left_state != left_motor_state) || (left_pct != left_motor_pwm) ||
+        (right_state != right_motor_state) || (right_pct != right_motor_pwm)) {
+        setReg16(TPM1C0V, c0_value);
+        setReg16(TPM1C1V, c1_value);
+        setReg16(TPM1C2V, c2_value);
+        setReg16(TPM1C3V, c3_value);
+    
+        left_motor_state = left_state;
+        left_motor_pwm = left_pct;
+        right_motor_state = right_state;
+        right_motor_pwm = right_pct;
+        set_vehicle_state(); 
+    }
+    RESTORE_INTERRUPTS(ccr);
+}
+
 //----------------------------------------------------------------------------
 // set_motor : configure a motor
 // =========
 //
 // Notes
-//      The motor speed is specified in the range of 0 to 100% which is
-//      converted to the range 0 to 250 for use in the routine 'SetRatio8"
+//      Changes one motor through set_motors, leaving the other as it is.
 //
 // Parameters
 //      unit      : LEFT_MOTOR or RIGHT_MOTOR
@@ -289,62 +364,58 @@ void set_vehicle_state(void) {
 //
 void  set_motor(motor_t unit, motor_state_t state, uint8_t pwm_width) {
 
-uint16_t  pulse_count, period_count ;
-
-    period_count = TPM1MOD;        // get current period count (e.g. 889 for 5kHz frequency)
-    pulse_count = (period_count/100) * (100 - pwm_width);
-    
     if (unit == LEFT_MOTOR) {
-        switch (state) {
-            case MOTOR_OFF :        // set FREEWHEEL condition
-                setReg16(TPM1C0V, 0);     // set LOW on PWM1 and PWM2
-                setReg16(TPM1C1V, 0);                
-                left_motor_state = MOTOR_OFF;
-                break;
-            case MOTOR_FORWARD :    // set LOW on PWM2 and LM_PWM on LM_PWM1                                
-                setReg16(TPM1C0V, pulse_count);       // set LOW on LM_PWM1
-                setReg16(TPM1C1V, period_count);      // set pwm on LM_PWM2           
-                left_motor_state = MOTOR_FORWARD;
-                break;
-            case MOTOR_BACKWARD :   // set LOW on PWM1 and PWM on PWM2
-                setReg16(TPM1C0V, period_count);      // set pwm on LM_PWM1
-                setReg16(TPM1C1V, pulse_count);       // set LOW on LM_PWM2    
-                left_motor_state = MOTOR_BACKWARD;
-                break;
-            case MOTOR_BRAKE :      // set BRAKE condition
-                setReg16(TPM1C0V, period_count);     // set HIGH on LM_PWM1 and LM_PWM2
-                setReg16(TPM1C1V, period_count);
-                left_motor_state = MOTOR_BRAKE;
-                break;
-        } 
+        set_motors(state, pwm_width, (motor_state_t)right_motor_state, right_motor_pwm);
+    } else {
+        set_motors((motor_state_t)left_motor_state, left_motor_pwm, state, pwm_width);
     }
-    
-    if (unit == RIGHT_MOTOR) {
-        switch (state) {
-            case MOTOR_OFF :        // set FREEWHEEL condition
-                setReg16(TPM1C2V, 0);     // set LOW on RM_PWM1 and RM_PWM2
-                setReg16(TPM1C3V, 0);
-                left_motor_state = MOTOR_OFF;
-                break;
-            case MOTOR_FORWARD :    // set LOW on RM_PWM2 and pwm on LM_PWM1
-                setReg16(TPM1C2V, period_count);      // set pwm on RM_PWM1
-                setReg16(TPM1C3V, pulse_count);       // set LOW on RM_PWM2
-                left_motor_state = MOTOR_FORWARD;
-                break;
-            case MOTOR_BACKWARD :   // set LOW on RM_PWM1 and RM_PWM2
-                setReg16(TPM1C2V, pulse_count);       // set LOW on RM_PWM1
-                setReg16(TPM1C3V, period_count);      // set pwm on RM_PWM2
-                left_motor_state = MOTOR_BACKWARD;
-                break;
-            case MOTOR_BRAKE :      // set BRAKE condition
-                setReg16(TPM1C2V, period_count);     // set HIGH on RM_PWM1 and RM_PWM2
-                setReg16(TPM1C3V, period_count);
-                left_motor_state = MOTOR_BRAKE;
-                break;
-        }
+}
+
+//----------------------------------------------------------------------------
+// run_mode : run one of the system modes
+// ========
+//
+// Parameters
+//      mode : JOYSTICK_MODE -> EXPERIMENT_MODE
+//
+// Notes
+//      Returns when the mode exits. Used by the mode menu and the serial
+//      command shell.
+//
+void run_mode(sys_modes_t mode) {
+
+    flush_switch_events();                  // edges from the menu are history
+    switch (mode){
+        case JOYSTICK_MODE :                             // done
+            run_joystick_mode();
+            break;                                                     
+        case ACTIVITY_MODE :                             // done
+            run_activity_mode();
+            break; 
+        case BUMP_MODE :                                 // in progress
+            run_bump_mode();
+            break;             
+        case FOLLOW_MODE :                               // done
+            run_follow_mode();
+            break;    
+        case PROGRAM_MODE :                              // in progress
+            run_program_mode();
+            break;
+        case SKETCH_MODE :                               // in progress
+            run_sketch_mode();
+            break; 
+        case LAB_MODE :                                  // in progress
+            run_lab_mode();
+            break; 
+        case DISTANCE_MODE :                             // in progress
+            run_distance_mode();
+            break; 
+        case EXPERIMENT_MODE :                           // done
+            run_experiment_mode();
+            break;              
+        default :
+            break;
     }
-    setReg8(TPM1SC, (TPM_OVFL_INT_DIS | TPM_EDGE_ALIGN | TPM_BUSCLK | TPM_PRESCAL_DIV1));  
-    set_vehicle_state(); 
 }
 
 //----------------------------------------------------------------------------
@@ -353,8 +424,9 @@ uint16_t  pulse_count, period_count ;
 //
 void vehicle_stop(void) {
 
-    set_motor(RIGHT_MOTOR, MOTOR_BRAKE, 0);
-    set_motor(LEFT_MOTOR , MOTOR_BRAKE, 0);
+    move_abort();
+    speed_control_off();
+    set_motors(MOTOR_BRAKE, 0, MOTOR_BRAKE, 0);
 }
 
 //----------------------------------------------------------------------------
@@ -438,20 +510,16 @@ uint8_t   value_1, value_2;
     WAIT_SWITCH_PRESSED(switch_A);
     WAIT_SWITCH_RELEASED(switch_A);
     clr_LED(LED_A);
-    set_motor(LEFT_MOTOR, MOTOR_FORWARD, 60);
-    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, 60);
+    set_motors(MOTOR_FORWARD, 60, MOTOR_FORWARD, 60);
     DelayMs(5000);
-    set_motor(LEFT_MOTOR, MOTOR_OFF, 0);
-    set_motor(RIGHT_MOTOR, MOTOR_OFF, 0);
+    set_motors(MOTOR_OFF, 0, MOTOR_OFF, 0);
 //
 // 4. test robot turning to the left for 5 seconds
 //
     PROMPT_SWITCH_A;
-    set_motor(LEFT_MOTOR, MOTOR_BACKWARD, 60);
-    set_motor(RIGHT_MOTOR, MOTOR_FORWARD, 60);
+    set_motors(MOTOR_BACKWARD, 60, MOTOR_FORWARD, 60);
     DelayMs(3000);
-    set_motor(LEFT_MOTOR, MOTOR_OFF, 0);
-    set_motor(RIGHT_MOTOR, MOTOR_OFF, 0);
+    set_motors(MOTOR_OFF, 0, MOTOR_OFF, 0);
 //
 // 5. set POTs to mid positions 
 //
@@ -572,37 +640,7 @@ uint16_t  ticks;
             show_dual_chars('r', ('0'+ mode), 0);
             WAIT_SWITCH_RELEASED(switch_A);     // wait until button returns to quiescent state
             play_tune(&snd_goto_selection);
-            switch (mode){
-                case JOYSTICK_MODE :                             // done
-                    run_joystick_mode();
-                    break;                                                     
-                case ACTIVITY_MODE :                             // done
-                    run_activity_mode();
-                    break; 
-                case BUMP_MODE :                                 // in progress
-                    run_bump_mode();
-                    break;             
-                case FOLLOW_MODE :                               // done
-                    run_follow_mode();
-                    break;    
-                case PROGRAM_MODE :                              // in progress
-                    run_program_mode();
-                    break;
-                case SKETCH_MODE :                               // in progress
-                    run_sketch_mode();
-                    break; 
-                case LAB_MODE :                                  // in progress
-                    run_lab_mode();
-                    break; 
-                case DISTANCE_MODE :                             // in progress
-                    run_distance_mode();
-                    break; 
-                case EXPERIMENT_MODE :                           // done
-                    run_experiment_mode();
-                    break;              
-                default :
-                    break;
-            }
+            run_mode(mode);
             R_MODE_LEDS;
             show_dual_chars('r', ('0' + mode), (A_TO_FLASH | 10));
         }
@@ -624,6 +662,13 @@ uint16_t  ticks;
                 last_mode = EXPERIMENT_MODE;
             }
         }  
+//
+//  check for serial commands
+//
+        shell_poll();
+        runlog_idle();
+        flash_job_poll();
+        flush_switch_events();              // menu polls switch_X, not the queue
     }
 }
 
@@ -10,7 +10,19 @@ uint8_t     LED_image, LED_state, display_image, swap_image, LED_flash_map, disp
 
 uint8_t     LED_store[6][2], LED_store_pt;
 
-seven_seg_display_t    robot_display, temp_display;
+//
+// 7-segment frames
+//
+// The display tasks show the frame at "display_front", which may be in RAM
+// or a ROM message. A new frame is built in whichever of "display_frame"
+// is not being shown and handed to the display tasks through
+// "display_next". The multiplex task swaps the pointer between two ticks
+// so a frame is never shown half written.
+//
+seven_seg_display_t                 display_frame[2];
+const seven_seg_display_t           *display_front;     // frame being shown
+const seven_seg_display_t *volatile display_next;       // frame to show next, NULL if none
+uint8_t                             display_char_ptr, display_shift_count;
 
 //----------------------------------------------------------------------------
 // set of common 7-segment patterns
@@ -55,24 +67,79 @@ void display_init(void)
     clr_LED(LED_C);
     clr_LED(LED_D);
     LED_store_pt = 0;
-    CLEAR_DISPLAY;        
+    display_front = &zero_display;
+    display_next = NULL;
+    display_char_ptr = 0;
+    display_shift_count = 0;
 }
 
 //----------------------------------------------------------------------------
-// load_display : copy a display structure to the active 7-segment dispay structure
+// display_show : queue a frame to be shown from the next tick
+// ============
+//
+// Parameters
+//      frame : complete 7-segment frame (RAM or ROM), not changed after
+//
+// Notes
+//      Leaves the interrupt mask as it was, so can be used before
+//      interrupts are enabled at boot.
+//
+void display_show(const seven_seg_display_t *frame) 
+{
+uint8_t   ccr;
+
+    SAVE_INTERRUPTS(ccr);
+    display_next = frame;
+    RESTORE_INTERRUPTS(ccr);
+}
+
+//----------------------------------------------------------------------------
+// display_back : get a RAM frame that is not being shown
+// ============
+//
+// Parameters
+//      keep : if 1 the frame starts as a copy of the latest frame
+//
+// Returns
+//      pointer to frame, pass to display_show when complete
+//
+// Notes
+//      Any frame still waiting to be shown is cancelled, so it is never
+//      taken by the display task while being changed.
+//
+static seven_seg_display_t *display_back(uint8_t keep) 
+{
+const seven_seg_display_t   *latest;
+seven_seg_display_t         *back;
+uint8_t                     ccr;
+
+    SAVE_INTERRUPTS(ccr);
+    latest = (display_next != NULL) ? display_next : display_front;
+    display_next = NULL;
+    RESTORE_INTERRUPTS(ccr);
+    back = (display_front == &display_frame[0]) ? &display_frame[1] : &display_frame[0];
+    if ((keep == 1) && (latest != back)) {
+        memcpy(back, latest, sizeof(seven_seg_display_t));
+        back->char_ptr = display_char_ptr;
+        back->shift_count = display_shift_count;
+    }
+    return back;
+}
+
+//----------------------------------------------------------------------------
+// load_display : show a pre-prepared 7-segment display structure
 // ============
 //
 // Parameters
 //      display_struct : pointer to a 7-segment display structure
 //
 // Description
-//      Copy an pre-prepared 7-segment display structure into the working display 
-//      structure. Most likely, the pre-prepared structure will be held in ROM
-//      space. 
+//      Most likely, the pre-prepared structure will be held in ROM space.
+//      It is shown in place, not copied.
 //
-void load_display(seven_seg_display_t   *display_struct) 
+void load_display(const seven_seg_display_t   *display_struct) 
 {
-    memcpy(&robot_display, display_struct, sizeof(seven_seg_display_t));
+    display_show(display_struct);
 }
 
 //----------------------------------------------------------------------------
@@ -88,21 +155,27 @@ void load_display(seven_seg_display_t   *display_struct)
 //
 void show_dual_chars(char B_char, char A_char, uint8_t mode) 
 {
-    robot_display.char_count = 2;
-    robot_display.data_A[0] = char_to_7seg[A_char];
+seven_seg_display_t   *frame;
+
+    frame = display_back(0);
+    frame->mode = SEVEN_SEG_AB;
+    frame->char_count = 2;
+    frame->data_A[0] = char_to_7seg[A_char];
     if ((mode & A_TO_FLASH) == A_TO_FLASH) {
-        robot_display.data_A[1] = CHAR_CLR;
+        frame->data_A[1] = CHAR_CLR;
     } else {
-        robot_display.data_A[1] = char_to_7seg[A_char];
+        frame->data_A[1] = char_to_7seg[A_char];
     }
-    robot_display.data_B[0] = char_to_7seg[B_char];
+    frame->data_B[0] = char_to_7seg[B_char];
     if ((mode & B_TO_FLASH) == B_TO_FLASH) {
-        robot_display.data_B[1] = CHAR_CLR;
+        frame->data_B[1] = CHAR_CLR;
     } else {
-        robot_display.data_B[1] = char_to_7seg[B_char];
+        frame->data_B[1] = char_to_7seg[B_char];
     }    
-    robot_display.shift_rate = (mode & 0x3F) << 3;
-    robot_display.char_ptr = 0;
+    frame->shift_rate = (mode & 0x3F) << 3;
+    frame->shift_count = 0;
+    frame->char_ptr = 0;
+    display_show(frame);
     return;
 }
 
@@ -117,22 +190,29 @@ void show_dual_chars(char B_char, char A_char, uint8_t mode)
 //
 void show_char(uint8_t segment_no, uint8_t char_code, uint8_t flash_mode) 
 {
-    robot_display.char_count = 2;
+seven_seg_display_t   *frame;
+
+    frame = display_back(1);            // other character is kept
+    frame->char_count = 2;
+    if (frame->char_ptr >= 2) {
+        frame->char_ptr = 0;
+    }
     if (segment_no == SEVEN_SEG_A) {
-        robot_display.data_A[0] = char_code;
+        frame->data_A[0] = char_code;
         if (flash_mode == FLASH_ON) {
-            robot_display.data_A[1] = CHAR_CLR;
+            frame->data_A[1] = CHAR_CLR;
         } else {
-            robot_display.data_A[1] = char_code;
+            frame->data_A[1] = char_code;
         }
     } else {
-        robot_display.data_B[0] = char_code;
+        frame->data_B[0] = char_code;
         if (flash_mode == FLASH_ON) {
-            robot_display.data_B[1] = CHAR_CLR;
+            frame->data_B[1] = CHAR_CLR;
         } else {
-            robot_display.data_B[1] = char_code;
+            frame->data_B[1] = char_code;
         }
     }
+    display_show(frame);
     return;
 }
 
@@ -161,6 +241,7 @@ void show_char(uint8_t segment_no, uint8_t char_code, uint8_t flash_mode)
 //
 // Notes
 //      Populate the scroll display data structure from a given ASCII string
+//      (up to 15 characters, the rest are ignored)
 // Parameters
 //      string   : pointer to NULL terminated ASCII string 
 //      mode     : scroll rate
@@ -168,21 +249,25 @@ void show_char(uint8_t segment_no, uint8_t char_code, uint8_t flash_mode)
 void display_string(char *string, uint8_t mode)
 {
 uint8_t  chr_count;
+seven_seg_display_t   *frame;
 
-    temp_display.mode = SEVEN_SEG_AB;
-    temp_display.data_B[0] =  CHAR_CLR;
-    for (chr_count = 0 ; (*string != '\0') ; string++) {
-        temp_display.data_A[chr_count] = char_to_7seg[*string];
+    frame = display_back(0);
+    frame->mode = SEVEN_SEG_AB;
+    frame->data_B[0] =  CHAR_CLR;
+    for (chr_count = 0 ; (*string != '\0') && (chr_count < 15) ; string++) {
+        frame->data_A[chr_count] = char_to_7seg[*string];
         chr_count++;
-        temp_display.data_B[chr_count] = char_to_7seg[*string];
+        frame->data_B[chr_count] = char_to_7seg[*string];
     }
-    temp_display.data_A[chr_count] = CHAR_CLR;
-    temp_display.char_count = chr_count + 1;
-    temp_display.shift_rate = 80;
+    frame->data_A[chr_count] = CHAR_CLR;
+    frame->char_count = chr_count + 1;
+    frame->shift_rate = 80;
+    frame->shift_count = 0;
+    frame->char_ptr = 0;
 //
-//  now copy temp to actual display data structure
+//  now show the new frame
 //
-    memcpy(&robot_display, &temp_display, sizeof(seven_seg_display_t));
+    display_show(frame);
 }
 
 //----------------------------------------------------------------------------
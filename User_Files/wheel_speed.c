@@ -0,0 +1,165 @@
+//----------------------------------------------------------------------------
+//                  Robokid
+//----------------------------------------------------------------------------
+// wheel_speed.c : estimate wheel speeds from encoder edge times
+// =============
+//
+// Description
+//      The wheel encoders are sampled by the a/d background scan once per
+//      RTI tick, so an edge is time stamped to the tick in which it was
+//      seen. The time stamps come from a private tick counter rather than
+//      tick_count_16 as modes clear that counter with CLR_TIMER16.
+//
+//      Speed is found from the time between edges. At low speed this is
+//      the period of the last edge pair. At higher speed, when several
+//      edges fall within WHEEL_SPEED_WINDOW ticks, the span from the
+//      oldest of these to the newest is used. Averaging over up to 7
+//      periods gives a resolution of a few percent even though each edge
+//      is only known to within one tick.
+//
+//      When the wheel slows, the time since the last edge limits the
+//      speed, and after WHEEL_STOP_TICKS without an edge the speed is 0.
+//
+//      Speeds are in mm/S and have no sign as the encoders cannot detect
+//      direction.
+//
+// Author                Date          Comment
+//----------------------------------------------------------------------------
+// agent              19/10/2026      replaces unused 64 second count buffers
+//----------------------------------------------------------------------------
+
+#include "global.h"
+
+wheel_speed_t   wheel_speed[2];
+uint16_t        wheel_speed_ticks;          // free running tick count
+uint8_t         wheel_speed_sample_count;
+
+static void update_wheel(wheel_speed_t *wheel, uint8_t edge);
+
+//----------------------------------------------------------------------------
+// init_wheel_speed : clear speed estimator data
+// ================
+//
+// Notes
+//      Must be called before the RTI interrupt is enabled.
+//
+void init_wheel_speed(void) {
+
+uint8_t   i, j;
+
+    for (i=0 ; i < 2 ; i++) {
+        wheel_speed[i].edge_index = 0;
+        wheel_speed[i].edges = 0;
+        wheel_speed[i].count = 0;
+        wheel_speed[i].speed = 0;
+        wheel_speed[i].history_index = 0;
+        for (j=0 ; j < WHEEL_SPEED_HISTORY ; j++) {
+            wheel_speed[i].history[j] = 0;
+        }
+    }
+    wheel_speed_ticks = 0;
+    wheel_speed_sample_count = WHEEL_SPEED_SAMPLE;
+}
+
+//----------------------------------------------------------------------------
+// wheel_speed_update : update speed estimates
+// ==================
+//
+// Parameters
+//      left_edge  : 1 if left encoder changed on this tick
+//      right_edge : 1 if right encoder changed on this tick
+//
+// Notes
+//      Called from the RTI wheel encoder task every tick.
+//
+void wheel_speed_update(uint8_t left_edge, uint8_t right_edge) {
+
+uint8_t   i;
+
+    wheel_speed_ticks++;
+    update_wheel(&wheel_speed[LEFT_MOTOR], left_edge);
+    update_wheel(&wheel_speed[RIGHT_MOTOR], right_edge);
+    //
+    // store speeds in circular buffers
+    //
+    if (--wheel_speed_sample_count == 0) {
+        wheel_speed_sample_count = WHEEL_SPEED_SAMPLE;
+        for (i=0 ; i < 2 ; i++) {
+            wheel_speed[i].history[wheel_speed[i].history_index] = wheel_speed[i].speed;
+            wheel_speed[i].history_index = (wheel_speed[i].history_index + 1) & (WHEEL_SPEED_HISTORY - 1);
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// update_wheel : record edge and recalculate speed of one wheel
+// ============
+//
+static void update_wheel(wheel_speed_t *wheel, uint8_t edge) {
+
+uint16_t  newest, oldest, since, limit;
+uint8_t   periods;
+
+    if (edge == 1) {
+        wheel->edge_time[wheel->edge_index] = wheel_speed_ticks;
+        wheel->edge_index = (wheel->edge_index + 1) & (WHEEL_EDGE_HISTORY - 1);
+        if (wheel->edges < WHEEL_EDGE_HISTORY) {
+            wheel->edges++;
+        }
+        wheel->count++;
+    }
+    if (wheel->edges == 0) {
+        return;
+    }
+    newest = wheel->edge_time[(wheel->edge_index - 1) & (WHEEL_EDGE_HISTORY - 1)];
+    since = wheel_speed_ticks - newest;
+    if (since > WHEEL_STOP_TICKS) {         // stopped
+        wheel->edges = 0;
+        wheel->speed = 0;
+        return;
+    }
+    if (wheel->edges == 1) {                // no period yet
+        return;
+    }
+    //
+    // find oldest edge within speed window (always use at least one period)
+    //
+    periods = wheel->edges - 1;
+    FOREVER {
+        oldest = wheel->edge_time[(wheel->edge_index - 1 - periods) & (WHEEL_EDGE_HISTORY - 1)];
+        if ((periods == 1) || ((newest - oldest) <= WHEEL_SPEED_WINDOW)) {
+            break;
+        }
+        periods--;
+    }
+    wheel->speed = (periods * WHEEL_SPEED_K) / (newest - oldest);
+    //
+    // slowing down : no edge for longer than the measured period
+    //
+    if (since != 0) {
+        limit = WHEEL_SPEED_K / since;
+        if (limit < wheel->speed) {
+            wheel->speed = limit;
+        }
+    }
+}
+
+//----------------------------------------------------------------------------
+// get_wheel_speed : read latest speed estimate
+// ===============
+//
+// Parameters
+//      wheel : LEFT_MOTOR or RIGHT_MOTOR
+//
+// Returns
+//      speed in mm/S
+//
+uint16_t get_wheel_speed(motor_t wheel) {
+
+uint16_t  speed;
+
+    DISABLE_INTERRUPTS;
+    speed = wheel_speed[wheel].speed;
+    ENABLE_INTERRUPTS;
+    return speed;
+}